@@ -0,0 +1,10 @@
+// ÿ֡õ͹Դݣframeuniforms.h
+layout (std140) uniform Frame {
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	mat4 lightSpaceMatrix;
+	vec3 viewPos;
+	vec3 lightPos;
+	vec3 lightDir;			// ƽйķ򣬴ӹԴָԭ
+};
\ No newline at end of file
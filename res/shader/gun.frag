@@ -6,8 +6,8 @@ struct Material {
 	float shininess;
 };
 
+// ԴλFrame
 struct Light {
-	vec3 position;
 	vec3 ambient;
 	vec3 diffuse;
 	vec3 specular;
@@ -19,7 +19,8 @@ in vec3 Position;
 
 out vec4 FragColor;
 
-uniform vec3 viewPos;
+#include "frame.glsl"
+
 uniform Material material;
 uniform Light light;
 
@@ -29,7 +30,7 @@ void main() {
 
 	// 
 	vec3 norm = normalize(Normal);
-	vec3 lightDir = normalize(light.position - Position);
+	vec3 lightDir = normalize(lightPos - Position);
 	float diff = max(dot(norm, lightDir), 0.0);
 	vec3 diffuse = light.diffuse * diff * texture(material.diffuse, TexCoord).rgb;
 
@@ -8,14 +8,21 @@ out vec3 Normal;
 out vec2 TexCoord;
 out vec3 Position;
 
-uniform mat4 projection;
-uniform mat4 view;
+#include "frame.glsl"
+
 uniform mat4 model;
+#ifdef NORMAL_MATRIX_UNIFORM
+uniform mat3 normalMatrix;		// transpose(inverse(mat3(model)))ÿλCPUϼһ
+#endif
 
 void main() {
 	Position = vec3(model * vec4(aPosition, 1.0));
+#ifdef NORMAL_MATRIX_UNIFORM
+	Normal = normalMatrix * aNormal;
+#else
 	Normal = mat3(transpose(inverse(model))) * aNormal;
+#endif
 	TexCoord = aTexCoord;
 
-	gl_Position = projection * view * vec4(Position, 1.0);
+	gl_Position = viewProjection * vec4(Position, 1.0);
 }
\ No newline at end of file
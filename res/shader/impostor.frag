@@ -0,0 +1,36 @@
+#version 330 core
+
+in vec3 Position;
+flat in vec3 Center;
+flat in float Radius;
+
+out vec4 FragColor;
+
+#include "frame.glsl"
+
+uniform vec3 color;
+
+#include "lighting.glsl"
+
+void main() {
+	// 󽻣ûнض
+	vec3 rayDir = normalize(Position - viewPos);
+	vec3 oc = viewPos - Center;
+	float b = dot(oc, rayDir);
+	float h = b * b - dot(oc, oc) + Radius * Radius;
+	if (h < 0.0)
+		discard;
+	vec3 hit = viewPos + (-b - sqrt(h)) * rayDir;
+
+	// д뽻
+	vec4 clip = viewProjection * vec4(hit, 1.0);
+	gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;
+
+	// Ӱ
+	float shadow = 0.0;
+#ifdef SHADOWS
+	shadow = ShadowCalculation(lightSpaceMatrix * vec4(hit, 1.0));
+#endif
+	vec3 result = Lighting((hit - Center) / Radius, hit, -rayDir, 1.0, shadow) * color;
+	FragColor = vec4(result, 1.0);
+}
\ No newline at end of file
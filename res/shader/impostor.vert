@@ -0,0 +1,30 @@
+#version 330 core
+
+// ʵݣxyzΪģwΪ
+layout (location = 3) in vec4 aInstance;
+
+out vec3 Position;
+flat out vec3 Center;
+flat out float Radius;
+
+#include "frame.glsl"
+
+uniform float radius;			// ǰ뾶
+
+void main() {
+	// ĸδҪ㻺
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+	Center = aInstance.xyz;
+	Radius = radius * aInstance.w;
+
+	// ηڹġֱߵƽϣСðס
+	vec3 toCenter = Center - viewPos;
+	float dist = length(toCenter);
+	vec3 dir = toCenter / dist;
+	vec3 right = normalize(cross(dir, abs(dir.y) > 0.99 ? vec3(1.0, 0.0, 0.0) : vec3(0.0, 1.0, 0.0)));
+	vec3 up = cross(right, dir);
+	float halfSize = Radius * dist / sqrt(max(dist * dist - Radius * Radius, 1e-4));
+
+	Position = Center + (right * corner.x + up * corner.y) * halfSize;
+	gl_Position = viewProjection * vec4(Position, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#version 330 core
+
+in vec3 Position;
+flat in vec3 Center;
+flat in float Radius;
+
+#include "frame.glsl"
+
+void main() {
+	// ع߷󽻣ֻд
+	vec3 oc = Position - Center;
+	float b = dot(oc, lightDir);
+	float h = b * b - dot(oc, oc) + Radius * Radius;
+	if (h < 0.0)
+		discard;
+	vec3 hit = Position + (-b - sqrt(h)) * lightDir;
+	vec4 clip = lightSpaceMatrix * vec4(hit, 1.0);
+	gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#version 330 core
+
+// ʵݣxyzΪģwΪ
+layout (location = 3) in vec4 aInstance;
+
+out vec3 Position;
+flat out vec3 Center;
+flat out float Radius;
+
+#include "frame.glsl"
+
+uniform float radius;			// ǰ뾶
+
+void main() {
+	// ͶӰ£ֱڹ߷򡢱߳Ϊֱðס
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+	Center = aInstance.xyz;
+	Radius = radius * aInstance.w;
+	vec3 right = normalize(cross(lightDir, abs(lightDir.y) > 0.99 ? vec3(1.0, 0.0, 0.0) : vec3(0.0, 1.0, 0.0)));
+	vec3 up = cross(right, lightDir);
+
+	Position = Center + (right * corner.x + up * corner.y) * Radius;
+	gl_Position = lightSpaceMatrix * vec4(Position, 1.0);
+}
\ No newline at end of file
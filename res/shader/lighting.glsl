@@ -0,0 +1,49 @@
+// 䡢СõӰգҪȰframe.glsl
+
+#ifdef SHADOWS
+uniform sampler2D shadowMap;
+
+float ShadowCalculation(vec4 fragPosLightSpace) {
+	vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+	projCoords = projCoords * 0.5 + 0.5;
+	float closestDepth = texture(shadowMap, projCoords.xy).r;
+	float currentDepth = projCoords.z;
+	float bias = 0.005;
+	float shadow = currentDepth - bias > closestDepth ? 1.0 : 0.0;
+	return shadow;
+}
+#endif
+
+// ϵԱɫΪshadowΪ1ʱֻл
+vec3 Lighting(vec3 norm, vec3 position, vec3 viewDir, float ambient, float shadow) {
+	vec3 lightColor = vec3(1.0);
+
+	// 
+	vec3 ambientLight = ambient * lightColor;
+
+	// 
+	vec3 toLight = normalize(lightPos - position);
+	float diff = max(dot(norm, toLight), 0.0);
+	vec3 directLight = diff * lightColor;
+
+#ifdef SPECULAR
+	// 淴䣬ʱԭĸ߹
+#if defined(PHONG)
+	// 䣺ߵļн
+	vec3 reflectDir = reflect(-toLight, norm);
+	float spec = pow(max(dot(viewDir, reflectDir), 0.0), 64.0);
+#elif defined(HALFWAY_REFLECT)
+	// С뷴ļн
+	vec3 reflectDir = reflect(-toLight, norm);
+	vec3 halfwayDir = normalize(toLight + viewDir);
+	float spec = pow(max(dot(halfwayDir, reflectDir), 0.0), 64.0);
+#else
+	// ׼Blinn-Phongļн
+	vec3 halfwayDir = normalize(toLight + viewDir);
+	float spec = pow(max(dot(norm, halfwayDir), 0.0), 64.0);
+#endif
+	directLight += spec * lightColor;
+#endif
+
+	return ambientLight + (1.0 - shadow) * directLight;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#version 330 core
+
+in vec3 Normal;
+in vec2 TexCoord;
+in vec3 Position;
+#ifdef SHADOWS
+in vec4 PosLightSpace;
+#endif
+
+out vec4 FragColor;
+
+#ifdef TEXTURED
+uniform sampler2D diffuse;
+#else
+uniform vec3 color;
+#endif
+uniform float ambientStrength;
+
+#include "frame.glsl"
+#include "lighting.glsl"
+
+void main() {
+#ifdef TEXTURED
+	vec3 baseColor = texture(diffuse, TexCoord).rgb;
+#else
+	vec3 baseColor = color;
+#endif
+
+#ifdef UNLIT
+	FragColor = vec4(baseColor, 1.0);
+#else
+	// Ӱ
+	float shadow = 0.0;
+#ifdef SHADOWS
+	shadow = ShadowCalculation(PosLightSpace);
+#endif
+	vec3 result = Lighting(normalize(Normal), Position, normalize(viewPos - Position), ambientStrength, shadow) * baseColor;
+	FragColor = vec4(result, 1.0);
+#endif
+}
\ No newline at end of file
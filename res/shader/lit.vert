@@ -0,0 +1,45 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+#ifdef INSTANCED
+// ʵݣxyzΪλãwΪ
+layout (location = 3) in vec4 aInstance;
+#endif
+
+out	vec3 Normal;
+out	vec2 TexCoord;
+out	vec3 Position;
+#ifdef SHADOWS
+out	vec4 PosLightSpace;
+#endif
+
+#include "frame.glsl"
+
+uniform mat4 model;
+#ifdef NORMAL_MATRIX_UNIFORM
+uniform mat3 normalMatrix;		// transpose(inverse(mat3(model)))ÿλCPUϼһ
+#endif
+
+void main() {
+#ifdef INSTANCED
+	vec3 localPosition = aPosition * aInstance.w + aInstance.xyz;
+#else
+	vec3 localPosition = aPosition;
+#endif
+	Position = vec3(model * vec4(localPosition, 1.0));
+	// ʱҪ
+#if defined(UNLIT)
+	Normal = aNormal;
+#elif defined(NORMAL_MATRIX_UNIFORM)
+	Normal = normalMatrix * aNormal;
+#else
+	Normal = transpose(inverse(mat3(model))) * aNormal;
+#endif
+	TexCoord = aTexCoord;
+#ifdef SHADOWS
+	PosLightSpace = lightSpaceMatrix * vec4(Position, 1.0);
+#endif
+	gl_Position = viewProjection * vec4(Position, 1.0);
+}
\ No newline at end of file
@@ -1,10 +1,13 @@
 #version 330 core
 
 layout (location = 0) in vec3 aPos;
+// ʵݣxyzΪλãwΪšδʱĬֵΪ(0, 0, 0, 1)任
+layout (location = 3) in vec4 aInstance;
+
+#include "frame.glsl"
 
-uniform mat4 lightSpaceMatrix;
 uniform mat4 model;
 
 void main() {
-    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
+    gl_Position = lightSpaceMatrix * model * vec4(aPos * aInstance.w + aInstance.xyz, 1.0);
 }
\ No newline at end of file
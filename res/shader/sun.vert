@@ -4,10 +4,10 @@ layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 
-uniform mat4 projection;
-uniform mat4 view;
+#include "frame.glsl"
+
 uniform mat4 model;
 
 void main() {
-	gl_Position = projection * view * model * vec4(aPosition, 1.0);
+	gl_Position = viewProjection * model * vec4(aPosition, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,112 @@
+#ifndef ASSETLOADER_H
+#define ASSETLOADER_H
+
+#include <glad/glad.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <chrono>
+using namespace std;
+
+// ̨ԴļȡģͽͼƬڹִ߳У
+// ɺѶӦϴУOpenGL߳ȡִ
+class AssetLoader {
+private:
+	vector<thread> workers;
+	deque<pair<function<void()>, function<void()> > > jobs;		// ȴִеͶӦϴ
+	deque<function<void()> > uploads;							// 롢ȴϴĲ
+	mutex lock;
+	condition_variable jobReady;		// Ҫ˳
+	condition_variable uploadReady;		// 
+	size_t pending;						// ύûϴ
+	bool stopping;
+public:
+	// threadCountΪ0ʱʹӲ߳1һOpenGL߳
+	AssetLoader(GLuint threadCount = 0) {
+		pending = 0;
+		stopping = false;
+		if (threadCount == 0) {
+			GLuint hardware = thread::hardware_concurrency();
+			threadCount = hardware > 1 ? hardware - 1 : 1;
+		}
+		for (GLuint i = 0; i < threadCount; i++)
+			workers.push_back(thread(&AssetLoader::Work, this));
+	}
+	// ִύ˳ûϴĲֱӶ
+	~AssetLoader() {
+		{
+			lock_guard<mutex> guard(lock);
+			stopping = true;
+		}
+		jobReady.notify_all();
+		for (size_t i = 0; i < workers.size(); i++)
+			workers[i].join();
+	}
+	// loadڹִ߳УܵOpenGLuploadloadɺOpenGLִ߳
+	void Load(function<void()> load, function<void()> upload) {
+		{
+			lock_guard<mutex> guard(lock);
+			jobs.push_back(make_pair(load, upload));
+			pending++;
+		}
+		jobReady.notify_one();
+	}
+	// ִϴִеĿOpenGL߳е
+	GLuint ProcessUploads() {
+		GLuint count = 0;
+		unique_lock<mutex> guard(lock);
+		while (!uploads.empty()) {
+			RunUpload(guard);
+			count++;
+		}
+		return count;
+	}
+	// ȴtimeoutֱɣִϴǷûɵOpenGL߳е
+	bool Poll(chrono::milliseconds timeout) {
+		unique_lock<mutex> guard(lock);
+		if (pending > 0 && uploads.empty())
+			uploadReady.wait_for(guard, timeout, [this] { return !uploads.empty(); });
+		while (!uploads.empty())
+			RunUpload(guard);
+		return pending > 0;
+	}
+private:
+	// ȡһϴִ
+	void RunUpload(unique_lock<mutex>& guard) {
+		function<void()> upload = uploads.front();
+		uploads.pop_front();
+		guard.unlock();
+		upload();
+		upload = nullptr;
+		guard.lock();
+		pending--;
+	}
+
+	void Work() {
+		while (true) {
+			pair<function<void()>, function<void()> > job;
+			{
+				unique_lock<mutex> guard(lock);
+				jobReady.wait(guard, [this] { return stopping || !jobs.empty(); });
+				if (jobs.empty())
+					return;
+				job = jobs.front();
+				jobs.pop_front();
+			}
+			job.first();
+			// ͷеԴã֤ԴֻOpenGL߳
+			job.first = nullptr;
+			{
+				lock_guard<mutex> guard(lock);
+				uploads.push_back(nullptr);
+				uploads.back().swap(job.second);
+			}
+			uploadReady.notify_one();
+		}
+	}
+};
+
+#endif // !ASSETLOADER_H
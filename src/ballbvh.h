@@ -0,0 +1,238 @@
+#ifndef BALLBVH_H
+#define BALLBVH_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+using namespace glm;
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+using namespace std;
+#include "ballpool.h"
+
+const GLuint BVHLEAFSIZE = 4;			// ҶڵСĿ
+const GLuint MAXPACKETRAYS = 64;		// һ߰Ŀ
+
+// ΧвνṹĽڵ㣬ӽڵڸڵ
+struct BVHNode {
+	vec3 minCorner;
+	vec3 maxCorner;
+	GLuint first;						// ҶڵΪһСorderеλãڲڵΪӽڵţӽڵ
+	GLuint count;						// ҶڵСĿڲڵΪ0
+};
+
+// СİΧвνṹBVHڶͬʱ
+// ڵͨС򣬱ɾСʧЧԶСƶֻԵϸ°Χ
+class BallBVH {
+private:
+	vector<BVHNode> nodes;
+	vector<BallHandle> order;			// ҶڵõС
+	vector<GLuint> items;				// ʱС
+	vector<vec3> centers;				// ʱ
+	vector<pair<GLuint, uint64_t> > stack;	// ʱĽڵȻЧ
+	vector<vec3> invDirs;				// ߷ĵ
+	vector<float> nearest;				// ÿо
+	vector<GLuint> nearestIndex;		// ÿеС
+	float radius;						// С뾶
+	bool valid;							// ṹǷСһ£СҪؽ
+	float fitTime;						// ΧжӦСʱ
+public:
+	BallBVH(float radius) {
+		this->radius = radius;
+		this->valid = false;
+		this->fitTime = 0;
+		invDirs.resize(MAXPACKETRAYS);
+		nearest.resize(MAXPACKETRAYS);
+		nearestIndex.resize(MAXPACKETRAYS);
+	}
+	// λ½
+	void Build(BallPool& pool) {
+		GLuint count = pool.Size();
+		nodes.clear();
+		order.clear();
+		items.clear();
+		fitTime = pool.GetTime();
+		centers.clear();
+		for (GLuint i = 0; i < count; i++) {
+			items.push_back(i);
+			centers.push_back(pool.GetPosition(i));
+		}
+
+		BVHNode root;
+		root.first = 0;
+		root.count = count;
+		nodes.push_back(root);
+		if (count > 0)
+			BuildNode(0, 0, count);
+		else
+			SetEmpty(nodes[0]);
+
+		for (GLuint i = 0; i < count; i++)
+			order.push_back(pool.GetHandle(items[i]));
+		valid = true;
+	}
+	// СƶԵϸ°ΧУıṹʱûб仯ʱֱӷ
+	void Refit(BallPool& pool) {
+		if (!valid || fitTime == pool.GetTime())
+			return;
+		fitTime = pool.GetTime();
+		for (GLuint i = nodes.size(); i-- > 0;) {
+			BVHNode& node = nodes[i];
+			if (node.count > 0) {
+				SetEmpty(node);
+				for (GLuint j = node.first; j < node.first + node.count; j++) {
+					if (!pool.IsValid(order[j]))
+						continue;
+					vec3 center = pool.GetPosition(pool.IndexOf(order[j]));
+					node.minCorner = min(node.minCorner, center - vec3(radius));
+					node.maxCorner = max(node.maxCorner, center + vec3(radius));
+				}
+			}
+			else if (node.first != 0) {
+				node.minCorner = min(nodes[node.first].minCorner, nodes[node.first + 1].minCorner);
+				node.maxCorner = max(nodes[node.first].maxCorner, nodes[node.first + 1].maxCorner);
+			}
+		}
+	}
+	// СṹʧЧ´ǰҪؽ
+	void Invalidate() {
+		valid = false;
+	}
+
+	bool IsValid() {
+		return valid;
+	}
+	// ͬһһߣMAXPACKETRAYSͬʱdirsǵλ
+	// pierceΪtrueʱ¼беС򣬷ÿֻ¼һhitsеŴСҲظ
+	void IntersectPacket(BallPool& pool, vec3 origin, const vec3* dirs, GLuint rayCount, bool pierce, vector<GLuint>& hits) {
+		hits.clear();
+		rayCount = std::min(rayCount, MAXPACKETRAYS);
+		if (!valid || rayCount == 0 || order.empty())
+			return;
+
+		for (GLuint r = 0; r < rayCount; r++) {
+			invDirs[r] = vec3(1.0f) / dirs[r];
+			nearest[r] = INFINITY;
+			nearestIndex[r] = 0;
+		}
+
+		float radius2 = radius * radius;
+		uint64_t all = rayCount == 64 ? ~(uint64_t)0 : (((uint64_t)1 << rayCount) - 1);
+		stack.clear();
+		stack.push_back(make_pair(0u, all));
+		while (!stack.empty()) {
+			GLuint index = stack.back().first;
+			uint64_t mask = stack.back().second;
+			stack.pop_back();
+
+			const BVHNode& node = nodes[index];
+			mask = IntersectBox(node, origin, mask, pierce);
+			if (mask == 0)
+				continue;
+
+			if (node.count == 0) {
+				// ȴϽӽڵ㣬ھ
+				const BVHNode& left = nodes[node.first];
+				const BVHNode& right = nodes[node.first + 1];
+				vec3 toLeft = (left.minCorner + left.maxCorner) * 0.5f - origin;
+				vec3 toRight = (right.minCorner + right.maxCorner) * 0.5f - origin;
+				if (dot(toLeft, toLeft) < dot(toRight, toRight)) {
+					stack.push_back(make_pair(node.first + 1, mask));
+					stack.push_back(make_pair(node.first, mask));
+				}
+				else {
+					stack.push_back(make_pair(node.first, mask));
+					stack.push_back(make_pair(node.first + 1, mask));
+				}
+				continue;
+			}
+
+			for (GLuint j = node.first; j < node.first + node.count; j++) {
+				if (!pool.IsValid(order[j]))
+					continue;
+				GLuint ball = pool.IndexOf(order[j]);
+				vec3 oc = pool.GetPosition(ball) - origin;
+				float c = dot(oc, oc) - radius2;
+				for (GLuint r = 0; r < rayCount; r++) {
+					if (!(mask & ((uint64_t)1 << r)))
+						continue;
+					float b = dot(oc, dirs[r]);
+					float disc = b * b - c;
+					if (disc < 0 || (b < 0 && c > 0))
+						continue;
+					float t = std::max(b - sqrt(disc), 0.0f);
+					if (pierce)
+						hits.push_back(ball);
+					else if (t < nearest[r]) {
+						nearest[r] = t;
+						nearestIndex[r] = ball;
+					}
+				}
+			}
+		}
+
+		if (!pierce)
+			for (GLuint r = 0; r < rayCount; r++)
+				if (nearest[r] != INFINITY)
+					hits.push_back(nearestIndex[r]);
+		sort(hits.begin(), hits.end());
+		hits.erase(unique(hits.begin(), hits.end()), hits.end());
+	}
+private:
+	void BuildNode(GLuint index, GLuint begin, GLuint end) {
+		vec3 minCenter = centers[items[begin]], maxCenter = minCenter;
+		for (GLuint i = begin + 1; i < end; i++) {
+			minCenter = min(minCenter, centers[items[i]]);
+			maxCenter = max(maxCenter, centers[items[i]]);
+		}
+		nodes[index].minCorner = minCenter - vec3(radius);
+		nodes[index].maxCorner = maxCenter + vec3(radius);
+
+		if (end - begin <= BVHLEAFSIZE) {
+			nodes[index].first = begin;
+			nodes[index].count = end - begin;
+			return;
+		}
+
+		// ķֲᰴλ
+		vec3 extent = maxCenter - minCenter;
+		int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+		GLuint middle = (begin + end) / 2;
+		const vector<vec3>& c = centers;
+		nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end,
+			[&c, axis](GLuint a, GLuint b) { return c[a][axis] < c[b][axis]; });
+
+		GLuint left = nodes.size();
+		nodes[index].first = left;
+		nodes[index].count = 0;
+		nodes.push_back(BVHNode());
+		nodes.push_back(BVHNode());
+		BuildNode(left, begin, middle);
+		BuildNode(left + 1, middle, end);
+	}
+
+	void SetEmpty(BVHNode& node) {
+		node.minCorner = vec3(INFINITY);
+		node.maxCorner = vec3(-INFINITY);
+	}
+	// ΧеslabԣΧཻ
+	// ֻȡʱΧбȸелԶͲټ
+	uint64_t IntersectBox(const BVHNode& node, vec3 origin, uint64_t mask, bool pierce) {
+		uint64_t result = 0;
+		for (GLuint r = 0; mask != 0; r++, mask >>= 1) {
+			if (!(mask & 1))
+				continue;
+			vec3 t0 = (node.minCorner - origin) * invDirs[r];
+			vec3 t1 = (node.maxCorner - origin) * invDirs[r];
+			vec3 tNear = min(t0, t1), tFar = max(t0, t1);
+			float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+			float exit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+			if (enter <= exit && (pierce || enter <= nearest[r]))
+				result |= (uint64_t)1 << r;
+		}
+		return result;
+	}
+};
+
+#endif // !BALLBVH_H
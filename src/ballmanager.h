@@ -7,79 +7,173 @@ using namespace glm;
 #include <cstdlib>
 #include <ctime>
 #include <vector>
+#include <algorithm>
 using namespace std;
 #include "model.h"
 #include "shader.h"
 #include "camera.h"
+#include "ballpool.h"
+#include "spawngrid.h"
+#include "raycast.h"
+#include "ballbvh.h"
+#include "resourcemanager.h"
+#include "renderqueue.h"
+
+const GLuint SPAWNATTEMPTS = 30;		// һСೢԵĴ
+const float SPAWNDISTANCE = 10.0f;		// С֮С
+const float HITRADIUS = 2.236068f;		// жеİ뾶ԭжΧƽ5һ
+const GLuint PELLETS = 32;				// ǹÿĵĿ
+const float SPREAD = 4.0f;				// ǹɢǶ
+const float OVERLINE = 70.0f;			// С򵽴zʱϷ
+const float BALLSCALE = 5.0f;			// Сģ͵
+const float BALLRADIUS = 2.5f;			// źСİ뾶
+const float SHADOWTEXELS = 1024 / 200.0f;	// ͼÿλȵ
+const GLuint BALLMESH = 1;				// С
+const GLuint BALLIMPOSTOR = 2;			// ÿСһΣƬɫ
+const GLuint BALLFEATURES = SHADERSHADOWS | SHADERSPECULAR | SHADERHALFWAYREFLECT | SHADERINSTANCED | SHADERNORMALMATRIX;	// Сɫı
+const GLuint IMPOSTORFEATURES = SHADERSHADOWS | SHADERSPECULAR | SHADERHALFWAYREFLECT;		// ɫı
+
+// С򵽴յߵʱ
+struct BallDeadline {
+	float time;
+	BallHandle handle;
+};
 
 class BallManager {
 private:
 	vec2 windowSize;
 
-	Model* ball;
-	Shader* ballShader;
-	GLuint number;						// ǰСĿ
+	shared_ptr<Model> ball;
+	shared_ptr<Shader> ballShader;
+	PipelineState ballPipeline;
+	GLuint instanceVAO;					// Сģ͵Ļʵ
+	GLuint instanceVBO;					// ÿСʵݣxyzΪλãwΪ
+	GLuint instanceCapacity;			// ʵɵСĿ
+	vector<vec4> instances;				// ÿ֡ϴʵݣLOD
+	vector<GLuint> instanceLods;		// ÿСȾʹõLOD
+	GLuint lodStart[MAXLODS];			// ÿLODʵڻе
+	GLuint lodSize[MAXLODS];			// ÿLODʵĿ
+	float lodDistance[MAXLODS];			// ÿLODСľ룬ڻ
+	GLuint shadowLod;					// ӰʹõLODͶӰССͬ
+	GLuint renderMode;					// СĻƷʽBALLMESHBALLIMPOSTOR
+	shared_ptr<Shader> impostorShader;
+	shared_ptr<Shader> impostorDepthShader;	// Ӱʹõֻдȵİ汾
+	PipelineState impostorPipeline;
+	PipelineState impostorDepthPipeline;
+	GLuint impostorVAO;					// ֻʵԣεĶgl_VertexID
 	GLuint maxNumber;					// СĿ
 	vec3 basicPos;						// С
-	vector<vec3> position;				// ϴڵС
+	BallPool balls;						// ϴڵС
+	float time;							// Ϸе֡Сλʱٶ
+	vector<BallDeadline> deadlines;		// յߵʱеСѣеСڶѶʱƳ
+	SpawnGrid* grid;					// жСǷСص
+	SpawnStats spawnStats;				// Сͳ
+	bool pierce;						// ӵǷ͸͸ʱϵСȫУֻһ
+	vector<GLuint> hits;				// еС
+	GLuint weapon;						// 1ǹ2ǹ
+	BallBVH* bvh;						// ǹʱʹõİΧвνṹ
+	vector<vec3> pellets;				// ǹÿķ
 	float moveSpeed;					// Сƶٶ
 	GLuint score;						// ÷
 	GLuint gameModel;					// Ϸģʽ
-	vec3 lightPos;						// Դλ
-	mat4 lightSpaceMatrix;				// תΪԹԴΪĵ
 
 	Camera* camera;
+	ResourceManager* resources;
 	// ģͱ任
 	mat4 model;
-	mat4 projection;
-	mat4 view;
 public:
-	BallManager(vec2 windowSize, Camera* camera) {
+	BallManager(vec2 windowSize, Camera* camera, ResourceManager* resources) {
 		this->windowSize = windowSize;
 		this->camera = camera;
+		this->resources = resources;
 		basicPos = vec3(0.0, 5.0, -30.0);
-		number = 0;
+		grid = new SpawnGrid(vec2(basicPos.x - 30, basicPos.y), vec2(basicPos.x + 30, basicPos.y + 30), SPAWNDISTANCE);
+		spawnStats.attempts = 0;
+		spawnStats.spawned = 0;
+		spawnStats.failures = 0;
 		maxNumber = 3;
+		time = 0;
+		gameModel = 1;
+		pierce = true;
+		hits.reserve(64);
+		weapon = 1;
+		bvh = new BallBVH(HITRADIUS);
+		pellets.reserve(PELLETS);
+		deadlines.reserve(64);
 		moveSpeed = 0.1f;
 		score = 0;
-		this->lightPos = vec3(0.0, 400.0, 150.0);
-		mat4 lightProjection = ortho(-100.0f, 100.0f, -100.0f, 100.0f, 1.0f, 500.0f);
-		mat4 lightView = lookAt(lightPos, vec3(0.0f), vec3(0.0, 1.0, 0.0));
-		this->lightSpaceMatrix = lightProjection * lightView;
+		instanceCapacity = 0;
+		shadowLod = 0;
+		renderMode = BALLMESH;
+		for (GLuint i = 0; i < MAXLODS; i++) {
+			lodStart[i] = lodSize[i] = 0;
+			lodDistance[i] = 0.0f;
+		}
+		// ɫύԴڼ
+		LoadShader();
 		AddBall();
 		LoadModel();
 	}
+	~BallManager() {
+		glDeleteVertexArrays(1, &instanceVAO);
+		glDeleteVertexArrays(1, &impostorVAO);
+		glDeleteBuffers(1, &instanceVBO);
+		delete grid;
+		delete bvh;
+	}
 	// Ϸģʽ
 	void SetGameModel(GLuint num) {
 		gameModel = num;
+		ResetVelocity();
+	}
+	// СĿ
+	void SetMaxNumber(GLuint num) {
+		maxNumber = num;
+		AddBall();
+	}
+	// ӵǷ͸
+	void SetPierce(bool pierce) {
+		this->pierce = pierce;
+	}
+	// 
+	void SetWeapon(GLuint weapon) {
+		this->weapon = weapon;
+	}
+	// Сƶٶ
+	void SetMoveSpeed(float speed) {
+		moveSpeed = speed;
+		ResetVelocity();
+	}
+	// СĻƷʽ
+	void SetRenderMode(GLuint mode) {
+		renderMode = mode;
 	}
 	// ±任жǷС
 	void Update(vec3 pos, vec3 dir, bool isShoot) {
-		this->view = camera->GetViewMatrix();
-		this->projection = perspective(radians(camera->GetZoom()), windowSize.x / windowSize.y, 0.1f, 500.0f);
 
 		if (isShoot) {
-			vector<vec3> temp;
-			for (GLuint i = 0; i < position.size(); i++) {
-				vec3 des = (pos.z - position[i].z) / (-dir.z) * dir + pos;
-				if (pow(position[i].x - des.x, 2) + pow(position[i].y - des.y, 2) > 5) {
-					temp.push_back(position[i]);
-				}
-				else {
-					number--;
-					score++;
-				}
+			if (weapon == 2)
+				FirePellets(pos, dir);
+			else
+				RaySphere(pos, normalize(dir), balls.GetX(), balls.GetY(), balls.GetZ(), balls.Size(), HITRADIUS, pierce, hits);
+			// ŴӴСɾɾλõС򲻻ǱеС
+			for (GLuint i = hits.size(); i-- > 0;) {
+				grid->Remove(vec2(balls.GetPosition(hits[i])));
+				balls.Remove(hits[i]);
+				score++;
 			}
-			position = temp;
 		}
+		// ֻƽʱ䣬Сλõʱż
+		time++;
+		balls.SetTime(time);
+
 		if (gameModel == 1) {
 			AddBall();
+			UploadInstances();
 			return;
 		}
-		for (GLuint i = 0; i < position.size(); i++)
-			position[i].z += moveSpeed;
 
-		if (number == 0) {
+		if (balls.Empty()) {
 			maxNumber++;
 			if (maxNumber == 10) {
 				moveSpeed += 0.1f;
@@ -87,79 +181,234 @@ public:
 			}
 			AddBall();
 		}
+		UploadInstances();
 	}
-	// жϷǷ
+	// жϷǷѶ絽յߵСѾеС
 	bool IsOver() {
-		if (position.size() > 0)
-			if (position[0].z >= 70)
-				return true;
-		return false;
+		while (!deadlines.empty() && !balls.IsValid(deadlines.front().handle)) {
+			pop_heap(deadlines.begin(), deadlines.end(), LaterDeadline);
+			deadlines.pop_back();
+		}
+		return !deadlines.empty() && deadlines.front().time <= time;
 	}
 
 	GLuint GetScore() {
 		return score;
 	}
-	// ȾС
-	void Render(Shader* shader, GLuint depthMap = -1) {
-		for (GLuint i = 0; i < position.size(); i++) {
-			model = mat4(1.0);
-			model[3] = vec4(position[i], 1.0);
-			model = scale(model, vec3(5));
-			if (shader == NULL) {
-				shader = ballShader;
-				shader->Bind();
-				shader->SetMat4("projection", projection);
-				shader->SetMat4("view", view);
-			}
-			else {
-				shader->Bind();
-			}
-			shader->SetMat4("model", model);
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, depthMap);
-			glBindVertexArray(ball->GetVAO());
-			glDrawElements(GL_TRIANGLES, static_cast<GLuint>(ball->GetIndices().size()), GL_UNSIGNED_INT, 0);
-			
-			shader->Unbind();
-			glBindVertexArray(0);
-			model = mat4(1.0);
+
+	SpawnStats GetSpawnStats() {
+		return spawnStats;
+	}
+	// ύСӰȾÿLODһʵƣüСӰСʹͬһLOD
+	void Submit(RenderQueue* queue, const PipelineState* shadowPipeline, GLuint depthMap) {
+		if (balls.Empty())
+			return;
+		if (renderMode == BALLIMPOSTOR) {
+			SubmitImpostors(queue, depthMap);
+			return;
+		}
+		// źλѾʵУģ;Ϊλ
+		DrawPacket packet(PASSSHADOW, LAYEROPAQUE, GROUPBALLS, shadowPipeline);
+		packet.vertexArray = instanceVAO;
+		packet.draw = [this] { DrawLod(0, balls.Size(), shadowLod); };
+		queue->Submit(packet);
+
+		packet.pass = PASSMAIN;
+		packet.pipeline = &ballPipeline;
+		packet.textures[SHADOWUNIT] = depthMap;
+		for (GLuint lod = 0; lod < ball->GetLodCount(); lod++) {
+			if (lodSize[lod] == 0)
+				continue;
+			packet.depth = lodDistance[lod];
+			packet.draw = [this, lod] { DrawLod(lodStart[lod], lodSize[lod], lod); };
+			queue->Submit(packet);
 		}
 	}
 private:
 	void LoadModel() {
-		ball = new Model("res/model/dot.obj");
-		ballShader = new Shader("res/shader/ball.vert", "res/shader/ball.frag");
-		ballShader->Bind();
-		ballShader->SetVec3("color", vec3(0.2, 0.5, 0.5f));
-		ballShader->SetInt("shadowMap", 0);
-		ballShader->SetVec3("lightPos", lightPos);
-		ballShader->SetVec3("viewPos", camera->GetPosition());
-		ballShader->SetMat4("lightSpaceMatrix", lightSpaceMatrix);
-		ballShader->Unbind();
-	}
-	// С
+		ball = resources->GetSphere(PACKDEFAULT);
+		shadowLod = ball->SelectLod(BALLRADIUS * SHADOWTEXELS, SHADOWLODPIXELS);
+		// ģ׼ǹãʵԷڵVAOϣÿʵǰһ
+		glGenBuffers(1, &instanceVBO);
+		instanceVAO = ball->CreateVAO();
+		glBindVertexArray(instanceVAO);
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(vec4), (void*)0);
+		glVertexAttribDivisor(3, 1);
+
+		// ʵҪ
+		glGenVertexArrays(1, &impostorVAO);
+		glBindVertexArray(impostorVAO);
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(vec4), (void*)0);
+		glVertexAttribDivisor(3, 1);
+		glBindVertexArray(0);
+		UploadInstances();
+	}
+	// ύɫı룬uniformڱɺ
+	void LoadShader() {
+		ballShader = resources->GetShader("res/shader/lit.vert", "res/shader/lit.frag", BALLFEATURES, [](Shader* shader) {
+			shader->SetInt(UNIFORMSHADOWMAP, SHADOWUNIT);
+			shader->SetFloat(UNIFORMAMBIENTSTRENGTH, 1.0);
+			shader->SetVec3(UNIFORMCOLOR, vec3(0.2, 0.5, 0.5f));
+			shader->SetMat3(UNIFORMNORMALMATRIX, mat3(1.0));
+		});
+		ballPipeline = PipelineState(ballShader.get());
+
+		impostorShader = resources->GetShader("res/shader/impostor.vert", "res/shader/impostor.frag", IMPOSTORFEATURES, [](Shader* shader) {
+			shader->SetFloat(UNIFORMRADIUS, BALLRADIUS / BALLSCALE);
+			shader->SetInt(UNIFORMSHADOWMAP, SHADOWUNIT);
+			shader->SetVec3(UNIFORMCOLOR, vec3(0.2, 0.5, 0.5f));
+		});
+		impostorPipeline = PipelineState(impostorShader.get());
+
+		impostorDepthShader = resources->GetShader("res/shader/impostordepth.vert", "res/shader/impostordepth.frag", 0, [](Shader* shader) {
+			shader->SetFloat(UNIFORMRADIUS, BALLRADIUS / BALLSCALE);
+		});
+		impostorDepthPipeline = PipelineState(impostorDepthShader.get());
+	}
+	// СÿСһΣƬɫ㣬дȺͷ
+	void SubmitImpostors(RenderQueue* queue, GLuint depthMap) {
+		DrawPacket packet(PASSSHADOW, LAYEROPAQUE, GROUPBALLS, &impostorDepthPipeline);
+		packet.vertexArray = impostorVAO;
+		packet.draw = [this] { glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, balls.Size()); };
+		queue->Submit(packet);
+
+		packet.pass = PASSMAIN;
+		packet.pipeline = &impostorPipeline;
+		packet.textures[SHADOWUNIT] = depthMap;
+		packet.depth = SORTDEPTHRANGE;
+		for (GLuint lod = 0; lod < MAXLODS; lod++)
+			if (lodSize[lod] > 0)
+				packet.depth = glm::min(packet.depth, lodDistance[lod]);
+		queue->Submit(packet);
+	}
+	// ʵVAOϻƴӵstartʵʼcountС
+	void DrawLod(GLuint start, GLuint count, GLuint lod) {
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		SetInstanceOffset(start);
+		ball->DrawInstanced(count, lod);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	// СλúŰȾLODдʵÿ֡һΣӰȾ
+	void UploadInstances() {
+		const float* x = balls.GetX();
+		const float* y = balls.GetY();
+		const float* z = balls.GetZ();
+		// ͶӰ뾶أѡLODٰLOD
+		float focal = windowSize.y * 0.5f / tan(radians(camera->GetZoom()) * 0.5f);
+		vec3 eye = camera->GetPosition();
+		instanceLods.resize(balls.Size());
+		for (GLuint lod = 0; lod < MAXLODS; lod++) {
+			lodSize[lod] = 0;
+			lodDistance[lod] = SORTDEPTHRANGE;
+		}
+		for (GLuint i = 0; i < balls.Size(); i++) {
+			float ballDistance = distance(vec3(x[i], y[i], z[i]), eye);
+			float radiusPixels = BALLRADIUS * focal / glm::max(ballDistance, 0.1f);
+			GLuint lod = ball->SelectLod(radiusPixels, LODPIXELS);
+			instanceLods[i] = lod;
+			lodSize[lod]++;
+			lodDistance[lod] = glm::min(lodDistance[lod], ballDistance);
+		}
+		for (GLuint lod = 0, start = 0; lod < MAXLODS; lod++) {
+			lodStart[lod] = start;
+			start += lodSize[lod];
+		}
+		GLuint next[MAXLODS];
+		copy(lodStart, lodStart + MAXLODS, next);
+		instances.resize(balls.Size());
+		for (GLuint i = 0; i < balls.Size(); i++)
+			instances[next[instanceLods[i]]++] = vec4(x[i], y[i], z[i], BALLSCALE);
+
+		if (instances.size() > instanceCapacity)
+			instanceCapacity = std::max<GLuint>(instances.size(), instanceCapacity * 2);
+
+		// ·洢Զݣȴһ֡Ļ
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(vec4) * instanceCapacity, NULL, GL_STREAM_DRAW);
+		if (!instances.empty())
+			glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vec4) * instances.size(), &instances[0]);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	// ʵԴӻеstartʵʼȡǰҪVAOʵ
+	void SetInstanceOffset(GLuint start) {
+		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(vec4), (void*)(sizeof(vec4) * start));
+	}
+	// С򣬳ŲµСʱ´ٳ
 	void AddBall() {
-		for (GLuint i = number; i < maxNumber; i++) {
-			float judgeX = rand() % 2;
-			float x = (judgeX >= 0.5) ? rand() % 30: -(rand() % 30);
-			float y = rand() % 30;
-			vec3 pos = vec3(basicPos.x + x, basicPos.y + y, basicPos.z);
-			if (CheckPosition(pos)) {
-				position.push_back(pos);
-				number++;
+		while (balls.Size() < maxNumber) {
+			vec3 pos;
+			if (!FindPosition(pos)) {
+				spawnStats.failures++;
+				return;
 			}
-			else 
-				i--;
+			grid->Insert(vec2(pos));
+			PushDeadline(balls.Add(pos, BallVelocity()));
+			bvh->Invalidate();
+			spawnStats.spawned++;
+		}
+	}
+	// ǹ׼ΪİƽPELLETSߣͨBVHһ
+	void FirePellets(vec3 pos, vec3 dir) {
+		dir = normalize(dir);
+		vec3 right = normalize(cross(dir, abs(dir.y) < 0.99f ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+		vec3 up = cross(right, dir);
+		float spread = tan(radians(SPREAD));
+		pellets.clear();
+		for (GLuint i = 0; i < PELLETS; i++) {
+			float r = spread * sqrt((i + 0.5f) / PELLETS);
+			float angle = i * 2.399963f;
+			pellets.push_back(normalize(dir + right * (r * cos(angle)) + up * (r * sin(angle))));
 		}
+
+		if (!bvh->IsValid())
+			bvh->Build(balls);
+		else
+			bvh->Refit(balls);
+		bvh->IntersectPacket(balls, pos, &pellets[0], pellets.size(), pierce, hits);
+	}
+	// ģʽСֹսģʽСmoveSpeedƶ
+	vec3 BallVelocity() {
+		return vec3(0.0, 0.0, gameModel == 1 ? 0.0f : moveSpeed);
+	}
+	// ǰϷģʽƶٶСٶȣ¼㵽յߵʱ
+	void ResetVelocity() {
+		deadlines.clear();
+		for (GLuint i = 0; i < balls.Size(); i++) {
+			balls.SetVelocity(i, BallVelocity());
+			PushDeadline(balls.GetHandle(i));
+		}
+	}
+	// С򵽴յߵʱ䲢УֹС򲻻ᵽ
+	void PushDeadline(BallHandle handle) {
+		GLuint index = balls.IndexOf(handle);
+		float speed = balls.GetVelocity(index).z;
+		if (speed <= 0)
+			return;
+		BallDeadline deadline;
+		deadline.time = balls.GetSpawnTime(index) + (OVERLINE - balls.GetSpawnPosition(index).z) / speed;
+		deadline.handle = handle;
+		deadlines.push_back(deadline);
+		push_heap(deadlines.begin(), deadlines.end(), LaterDeadline);
 	}
-	// ѴСλãӵСص
-	bool CheckPosition(vec3 pos) {
-		for (GLuint i = 0; i < position.size(); i++) {
-			float away = pow(position[i].x - pos.x, 2) + pow(position[i].y - pos.y, 2);
-			if (away < 100)
-				return false;
+
+	static bool LaterDeadline(const BallDeadline& a, const BallDeadline& b) {
+		return a.time > b.time;
+	}
+	// ѰСصλãೢSPAWNATTEMPTS
+	bool FindPosition(vec3& pos) {
+		for (GLuint i = 0; i < SPAWNATTEMPTS; i++) {
+			spawnStats.attempts++;
+			float judgeX = rand() % 2;
+			float x = (judgeX >= 0.5) ? rand() % 30: -(rand() % 30);
+			float y = rand() % 30;
+			pos = vec3(basicPos.x + x, basicPos.y + y, basicPos.z);
+			if (grid->IsFree(vec2(pos)))
+				return true;
 		}
-		return true;
+		return false;
 	}
 };
 
@@ -0,0 +1,240 @@
+#ifndef BALLPOOL_H
+#define BALLPOOL_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+using namespace glm;
+#include <vector>
+using namespace std;
+
+// Сλúӣɾ֮ʧЧ
+struct BallHandle {
+	GLuint slot;
+	GLuint generation;
+};
+
+// УSoAСݣɾʱһС򻻵ɾλãʼս
+// С˶ֻʱλáٶȺʱ䣬ǰλҪʱż
+class BallPool {
+private:
+	// Сݣ±ΪյС
+	vector<float> spawnX;				// ʱλ
+	vector<float> spawnY;
+	vector<float> spawnZ;
+	vector<float> vx;					// ٶ
+	vector<float> vy;
+	vector<float> vz;
+	vector<float> spawnTime;			// ʱ
+	vector<GLuint> denseToSlot;			// СŶӦĲλ
+
+	// ǰʱλãʱıɾС¼
+	vector<float> x;
+	vector<float> y;
+	vector<float> z;
+	float time;							// ǰʱ
+	bool dirty;							// ǰλǷҪ¼
+	GLuint moving;						// ٶȲΪ0СĿΪ0ʱҪ¼
+
+	// λ
+	vector<GLuint> slotToDense;			// λӦС
+	vector<GLuint> generation;			// λĴ
+	vector<GLuint> freeSlots;			// вλ
+public:
+	BallPool(GLuint capacity = 64) {
+		time = 0;
+		dirty = false;
+		moving = 0;
+		Reserve(capacity);
+	}
+	// Ԥȷռ䣬ĿʱɾС򲻻ڴ
+	void Reserve(GLuint capacity) {
+		spawnX.reserve(capacity);
+		spawnY.reserve(capacity);
+		spawnZ.reserve(capacity);
+		x.reserve(capacity);
+		y.reserve(capacity);
+		z.reserve(capacity);
+		vx.reserve(capacity);
+		vy.reserve(capacity);
+		vz.reserve(capacity);
+		spawnTime.reserve(capacity);
+		denseToSlot.reserve(capacity);
+		slotToDense.reserve(capacity);
+		generation.reserve(capacity);
+		freeSlots.reserve(capacity);
+	}
+
+	// ڵǰʱһС
+	BallHandle Add(vec3 pos, vec3 velocity) {
+		GLuint slot;
+		if (freeSlots.empty()) {
+			slot = slotToDense.size();
+			slotToDense.push_back(0);
+			generation.push_back(0);
+		}
+		else {
+			slot = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		slotToDense[slot] = spawnX.size();
+
+		spawnX.push_back(pos.x);
+		spawnY.push_back(pos.y);
+		spawnZ.push_back(pos.z);
+		x.push_back(pos.x);
+		y.push_back(pos.y);
+		z.push_back(pos.z);
+		vx.push_back(velocity.x);
+		vy.push_back(velocity.y);
+		vz.push_back(velocity.z);
+		spawnTime.push_back(time);
+		denseToSlot.push_back(slot);
+		if (velocity != vec3(0.0))
+			moving++;
+
+		BallHandle handle = { slot, generation[slot] };
+		return handle;
+	}
+	// ɾindexСһСᱻƶindex
+	void Remove(GLuint index) {
+		GLuint last = spawnX.size() - 1;
+		GLuint slot = denseToSlot[index];
+		if (GetVelocity(index) != vec3(0.0))
+			moving--;
+
+		spawnX[index] = spawnX[last];
+		spawnY[index] = spawnY[last];
+		spawnZ[index] = spawnZ[last];
+		x[index] = x[last];
+		y[index] = y[last];
+		z[index] = z[last];
+		vx[index] = vx[last];
+		vy[index] = vy[last];
+		vz[index] = vz[last];
+		spawnTime[index] = spawnTime[last];
+		denseToSlot[index] = denseToSlot[last];
+		slotToDense[denseToSlot[index]] = index;
+
+		spawnX.pop_back();
+		spawnY.pop_back();
+		spawnZ.pop_back();
+		x.pop_back();
+		y.pop_back();
+		z.pop_back();
+		vx.pop_back();
+		vy.pop_back();
+		vz.pop_back();
+		spawnTime.pop_back();
+		denseToSlot.pop_back();
+
+		generation[slot]++;
+		freeSlots.push_back(slot);
+	}
+
+	bool Remove(BallHandle handle) {
+		if (!IsValid(handle))
+			return false;
+		Remove(slotToDense[handle.slot]);
+		return true;
+	}
+
+	void Clear() {
+		while (!spawnX.empty())
+			Remove(spawnX.size() - 1);
+	}
+
+	bool IsValid(BallHandle handle) {
+		return handle.slot < generation.size() && generation[handle.slot] == handle.generation;
+	}
+	// ӦСţЧ
+	GLuint IndexOf(BallHandle handle) {
+		return slotToDense[handle.slot];
+	}
+
+	BallHandle GetHandle(GLuint index) {
+		BallHandle handle = { denseToSlot[index], generation[denseToSlot[index]] };
+		return handle;
+	}
+	// õǰʱ䣬Сλ´ηʱ¼
+	void SetTime(float time) {
+		if (this->time == time)
+			return;
+		this->time = time;
+		dirty = dirty || moving > 0;
+	}
+
+	float GetTime() {
+		return time;
+	}
+
+	GLuint Size() {
+		return spawnX.size();
+	}
+
+	bool Empty() {
+		return spawnX.empty();
+	}
+	// ǰʱλ
+	vec3 GetPosition(GLuint index) {
+		float dt = time - spawnTime[index];
+		return vec3(spawnX[index] + vx[index] * dt, spawnY[index] + vy[index] * dt, spawnZ[index] + vz[index] * dt);
+	}
+
+	vec3 GetSpawnPosition(GLuint index) {
+		return vec3(spawnX[index], spawnY[index], spawnZ[index]);
+	}
+
+	vec3 GetVelocity(GLuint index) {
+		return vec3(vx[index], vy[index], vz[index]);
+	}
+
+	// ıٶȣԵǰλú͵ǰʱΪµ
+	void SetVelocity(GLuint index, vec3 velocity) {
+		vec3 pos = GetPosition(index);
+		if (GetVelocity(index) != vec3(0.0))
+			moving--;
+		if (velocity != vec3(0.0))
+			moving++;
+		spawnX[index] = pos.x;
+		spawnY[index] = pos.y;
+		spawnZ[index] = pos.z;
+		spawnTime[index] = time;
+		vx[index] = velocity.x;
+		vy[index] = velocity.y;
+		vz[index] = velocity.z;
+	}
+
+	float GetSpawnTime(GLuint index) {
+		return spawnTime[index];
+	}
+	// зʵǰʱλã
+	const float* GetX() {
+		Evaluate();
+		return x.data();
+	}
+
+	const float* GetY() {
+		Evaluate();
+		return y.data();
+	}
+
+	const float* GetZ() {
+		Evaluate();
+		return z.data();
+	}
+private:
+	// Сǰʱλ
+	void Evaluate() {
+		if (!dirty)
+			return;
+		for (GLuint i = 0; i < spawnX.size(); i++) {
+			float dt = time - spawnTime[i];
+			x[i] = spawnX[i] + vx[i] * dt;
+			y[i] = spawnY[i] + vy[i] * dt;
+			z[i] = spawnZ[i] + vz[i] * dt;
+		}
+		dirty = false;
+	}
+};
+
+#endif // !BALLPOOL_H
@@ -0,0 +1,67 @@
+#ifndef FRAMEUNIFORMS_H
+#define FRAMEUNIFORMS_H
+
+#include <glad/glad.h>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+using namespace glm;
+
+const vec3 LIGHTPOS(0.0, 400.0, 150.0);		// ԴλãҲ̫
+const GLuint FRAMEBINDING = 0;				// Frameİ󶨵㣬Shader
+
+// ɫFrameݣstd140֣vec3뵽16ֽ
+struct FrameData {
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	mat4 lightSpaceMatrix;				// תΪԹԴΪĵ
+	vec3 viewPos;
+	float padding0;
+	vec3 lightPos;
+	float padding1;
+	vec3 lightDir;						// ƽйķ򣬴ӹԴָԭ
+	float padding2;
+};
+
+// ÿ֡õ͹Դݣÿ֡ϴһεͳһɫͨFrameȡ
+class FrameUniforms {
+private:
+	GLuint UBO;
+	FrameData data;
+public:
+	FrameUniforms() {
+		memset(&data, 0, sizeof(data));
+		glGenBuffers(1, &UBO);
+		glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		glBindBufferBase(GL_UNIFORM_BUFFER, FRAMEBINDING, UBO);
+	}
+
+	~FrameUniforms() {
+		glDeleteBuffers(1, &UBO);
+	}
+	// ùԴԴ̶ʱֻҪһ
+	void SetLight(vec3 lightPos, mat4 lightSpaceMatrix) {
+		data.lightPos = lightPos;
+		data.lightDir = normalize(-lightPos);
+		data.lightSpaceMatrix = lightSpaceMatrix;
+	}
+	// ϴ
+	void Update(mat4 view, mat4 projection, vec3 viewPos) {
+		data.view = view;
+		data.projection = projection;
+		data.viewProjection = projection * view;
+		data.viewPos = viewPos;
+		glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	const FrameData& GetData() {
+		return data;
+	}
+};
+
+#endif // !FRAMEUNIFORMS_H
@@ -0,0 +1,140 @@
+#ifndef ICOSPHERE_H
+#define ICOSPHERE_H
+
+#include <glad/glad.h>
+#include <vector>
+using namespace std;
+#include "meshcache.h"
+
+// С׼ʹõϸּÿĿ4ڱѡ޸
+#ifndef BALL_SPHERE_LEVEL
+#define BALL_SPHERE_LEVEL 3
+#endif
+
+const float ICOSPHERERADIUS = 0.5f;		// ԭdot.objСһ
+
+// ڼƽţٵ
+constexpr float ConstexprSqrt(float x) {
+	if (x <= 0.0f)
+		return 0.0f;
+	float root = x > 1.0f ? x : 1.0f;
+	for (int i = 0; i < 64; i++) {
+		float next = 0.5f * (root + x / root);
+		if (next == root)
+			break;
+		root = next;
+	}
+	return root;
+}
+
+// ʮĶ
+constexpr float ICOSAHEDRONT = 1.6180339887f;
+constexpr float ICOSAHEDRONVERTICES[12][3] = {
+	{ -1.0f, ICOSAHEDRONT, 0.0f }, { 1.0f, ICOSAHEDRONT, 0.0f }, { -1.0f, -ICOSAHEDRONT, 0.0f }, { 1.0f, -ICOSAHEDRONT, 0.0f },
+	{ 0.0f, -1.0f, ICOSAHEDRONT }, { 0.0f, 1.0f, ICOSAHEDRONT }, { 0.0f, -1.0f, -ICOSAHEDRONT }, { 0.0f, 1.0f, -ICOSAHEDRONT },
+	{ ICOSAHEDRONT, 0.0f, -1.0f }, { ICOSAHEDRONT, 0.0f, 1.0f }, { -ICOSAHEDRONT, 0.0f, -1.0f }, { -ICOSAHEDRONT, 0.0f, 1.0f }
+};
+constexpr int ICOSAHEDRONFACES[20][3] = {
+	{ 0, 11, 5 }, { 0, 5, 1 }, { 0, 1, 7 }, { 0, 7, 10 }, { 0, 10, 11 },
+	{ 1, 5, 9 }, { 5, 11, 4 }, { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },
+	{ 3, 9, 4 }, { 3, 4, 2 }, { 3, 2, 6 }, { 3, 6, 8 }, { 3, 8, 9 },
+	{ 4, 9, 5 }, { 2, 4, 11 }, { 6, 2, 10 }, { 8, 6, 7 }, { 9, 8, 1 }
+};
+
+// ϸֺĶ㣨λáߡ깲8float
+template <int Level>
+struct IcosphereData {
+	static constexpr int SEGMENTS = 1 << Level;								// ÿ߷ֳɵĶ
+	static constexpr int FACEVERTICES = (SEGMENTS + 1) * (SEGMENTS + 2) / 2;
+	static constexpr int VERTEXCOUNT = 20 * FACEVERTICES;
+	static constexpr int INDEXCOUNT = 20 * SEGMENTS * SEGMENTS * 3;
+
+	GLfloat vertices[VERTEXCOUNT * 8];
+	GLuint indices[INDEXCOUNT];
+};
+
+// ÿ水껮ͶӰ档㰴ʮ嶥˳ۼӣ
+// ڹĶȫͬѷ
+template <int Level>
+constexpr IcosphereData<Level> MakeIcosphere() {
+	IcosphereData<Level> data{};
+	const int n = IcosphereData<Level>::SEGMENTS;
+	int vertex = 0;
+	int index = 0;
+	for (int f = 0; f < 20; f++) {
+		int base = vertex;
+		for (int i = 0; i <= n; i++) {
+			for (int j = 0; j <= i; j++) {
+				// ǵȨأŴСۼ
+				int ids[3] = { ICOSAHEDRONFACES[f][0], ICOSAHEDRONFACES[f][1], ICOSAHEDRONFACES[f][2] };
+				int weights[3] = { n - i, i - j, j };
+				for (int a = 0; a < 2; a++)
+					for (int b = 0; b < 2 - a; b++)
+						if (ids[b] > ids[b + 1]) {
+							int id = ids[b];
+							ids[b] = ids[b + 1];
+							ids[b + 1] = id;
+							int weight = weights[b];
+							weights[b] = weights[b + 1];
+							weights[b + 1] = weight;
+						}
+				float p[3] = { 0.0f, 0.0f, 0.0f };
+				for (int k = 0; k < 3; k++)
+					for (int c = 0; c < 3; c++)
+						p[c] += ICOSAHEDRONVERTICES[ids[k]][c] * weights[k];
+				float norm = ConstexprSqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+
+				GLfloat* v = &data.vertices[vertex * 8];
+				for (int c = 0; c < 3; c++) {
+					v[3 + c] = p[c] / norm;
+					v[c] = v[3 + c] * ICOSPHERERADIUS;
+				}
+				// СʹȡƽͶӰ
+				v[6] = 0.5f + v[3] * 0.5f;
+				v[7] = 0.5f - v[4] * 0.5f;
+				vertex++;
+			}
+		}
+		// iеjΪi * (i + 1) / 2 + jÿСһΣһ⻹һ
+		for (int i = 0; i < n; i++) {
+			for (int j = 0; j <= i; j++) {
+				int top = base + i * (i + 1) / 2 + j;
+				int bottom = base + (i + 1) * (i + 2) / 2 + j;
+				data.indices[index++] = top;
+				data.indices[index++] = bottom;
+				data.indices[index++] = bottom + 1;
+				if (j < i) {
+					data.indices[index++] = top;
+					data.indices[index++] = bottom + 1;
+					data.indices[index++] = top + 1;
+				}
+			}
+		}
+	}
+	return data;
+}
+
+// ɵֱӱ
+template <int Level>
+struct Icosphere {
+	static constexpr IcosphereData<Level> data = MakeIcosphere<Level>();
+
+	// ѵLevelԼֵĹlodCount׷ӵУÿһ
+	static void AppendLods(GLuint lodCount, vector<GLfloat>& vertices, vector<GLuint>& indices, vector<Submesh>& submeshes) {
+		Submesh submesh;
+		submesh.baseVertex = vertices.size() / 8;
+		submesh.firstIndex = indices.size();
+		submesh.count = IcosphereData<Level>::INDEXCOUNT;
+		submesh.material = 0;
+		vertices.insert(vertices.end(), data.vertices, data.vertices + IcosphereData<Level>::VERTEXCOUNT * 8);
+		indices.insert(indices.end(), data.indices, data.indices + IcosphereData<Level>::INDEXCOUNT);
+		submeshes.push_back(submesh);
+		if (lodCount > 1)
+			Icosphere<(Level > 0 ? Level - 1 : 0)>::AppendLods(lodCount - 1, vertices, indices, submeshes);
+	}
+};
+
+template <int Level>
+constexpr IcosphereData<Level> Icosphere<Level>::data;
+
+#endif // !ICOSPHERE_H
@@ -1,16 +1,55 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <fstream>
+#include <cstring>
+#include <chrono>
 #include "world.h"
+#include "scenario.h"
+#include "passtimer.h"
+#include "raycast.h"
 
-void OpenWindow();
+void OpenWindow(int width = 1960, int height = 1080, bool visible = true, int contextApi = GLFW_NATIVE_CONTEXT_API);
 void PrepareOpenGL();
+int RunBenchmark(Scenario& scenario, const string& outputPath);
+int RunRaycastBenchmark();
+void PrintStartup(double loadTime, double firstFrameTime);
 
 GLFWwindow* window;
 vec2 windowSize;
 
-int main() {
+const double TARGET_FRAME = 0.016667;                       // 1/60룬ʵ60֡
+
+int main(int argc, char* argv[]) {
+    // в--headless --frames N --scenario file --output file--raycast-bench
+    bool headless = false;
+    GLuint frames = 0;
+    string scenarioPath;
+    string outputPath = "benchmark.json";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0)
+            headless = true;
+        else if (strcmp(argv[i], "--raycast-bench") == 0)
+            return RunRaycastBenchmark();
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc)
+            scenarioPath = argv[++i];
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            outputPath = argv[++i];
+        else
+            cout << "Unknown argument: " << argv[i] << endl;
+    }
+
+    if (headless) {
+        Scenario scenario;
+        if (!scenarioPath.empty() && !scenario.Load(scenarioPath))
+            return -1;
+        if (frames > 0)
+            scenario.frames = frames;
+        return RunBenchmark(scenario, outputPath);
+    }
+
     // ֡
-    const double TARGET_FRAME = 0.016667;                   // 1/60룬ʵ60֡
     const double FRAME_ALPHA = 0.25;                        // ϵ
     double currentFrame;
     double deltaTime;
@@ -26,47 +65,218 @@ int main() {
     cin >> gameModel;
     cout << "\n";
         
+    // ʱӴڿʼ
+    auto startTime = chrono::high_resolution_clock::now();
     OpenWindow();
     PrepareOpenGL();
 
-    World world(window, windowSize);
+    GLuint score = 0;
+    {
+        World world(window, windowSize);
+        double loadTime = chrono::duration<double>(chrono::high_resolution_clock::now() - startTime).count();
+        bool firstFrame = true;
 
-    currentFrame = glfwGetTime();
-    lastFrame = currentFrame;
-
-    world.SetGameModel(gameModel);
-    float gameTime = 0;
-
-    while (!glfwWindowShouldClose(window) && !glfwGetKey(window, GLFW_KEY_ESCAPE)) {
-        // ֡
         currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
-        renderAccum += deltaTime;
 
-        if (renderAccum >= TARGET_FRAME) {
+        world.SetGameModel(gameModel);
+        float gameTime = 0;
+
+        while (!glfwWindowShouldClose(window) && !glfwGetKey(window, GLFW_KEY_ESCAPE)) {
+            // ֡
+            currentFrame = glfwGetTime();
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+            renderAccum += deltaTime;
+
+            if (renderAccum >= TARGET_FRAME) {
             
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-            renderAccum -= TARGET_FRAME;
+                renderAccum -= TARGET_FRAME;
 
-            world.Update(deltaTime);
-            if (world.IsOver())
+                world.Update(deltaTime);
+                if (world.IsOver())
+                    break;
+                world.Render();
+                glfwSwapBuffers(window);
+                if (firstFrame) {
+                    firstFrame = false;
+                    PrintStartup(loadTime, chrono::duration<double>(chrono::high_resolution_clock::now() - startTime).count());
+                }
+            }
+            else
+                glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+        score = world.GetScore();
+    }
+    // WorldʱͷGPUԴ֮
+    glfwTerminate();
+    cout << "----------------------------ĵ÷Ϊ" << score << " ----------------------------" << endl;
+    return 0;
+}
+// ޴й̶֡Ⱦ֡壬ѸȾ׶εĺʱдJSON
+int RunBenchmark(Scenario& scenario, const string& outputPath) {
+    srand(scenario.seed);
+
+    auto startTime = chrono::high_resolution_clock::now();
+    OpenWindow(scenario.width, scenario.height, false, scenario.contextApi);
+    if (window == NULL)
+        return -1;
+    PrepareOpenGL();
+    glfwSwapInterval(0);
+
+    // ֡壬洰ڵĬ֡
+    GLuint fbo, colorBuffer, depthBuffer;
+    glGenFramebuffers(1, &fbo);
+    glGenRenderbuffers(1, &colorBuffer);
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, scenario.width, scenario.height);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, scenario.width, scenario.height);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        cout << "Offscreen framebuffer is not complete" << endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    bool isOver = false;
+    {
+        PassTimer timer;
+        World world(window, windowSize);
+        world.SetMemoryBudget((size_t)scenario.memoryBudget * 1024 * 1024);
+        world.SetGameModel(scenario.gameModel);
+        world.SetMoveSpeed(scenario.moveSpeed);
+        world.SetMaxNumber(scenario.maxNumber);
+        world.SetPierce(scenario.pierce);
+        world.SetWeapon(scenario.weapon);
+        world.SetBallRenderMode(scenario.ballRenderer);
+        world.SetTimer(&timer);
+        world.SetTargetFramebuffer(fbo);
+        double loadTime = chrono::duration<double>(chrono::high_resolution_clock::now() - startTime).count();
+        double firstFrameTime = 0.0;
+
+        // ̶ʱ䲽ֻ֤ȡڳ
+        for (GLuint frame = 0; frame < scenario.frames; frame++) {
+            timer.BeginFrame();
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            bool isShoot = scenario.shootInterval > 0 && frame % scenario.shootInterval == 0;
+            timer.Begin("update");
+            world.Update(TARGET_FRAME, isShoot);
+            timer.End();
+            if (world.IsOver()) {
+                isOver = true;
+                timer.EndFrame();
                 break;
+            }
             world.Render();
+            timer.EndFrame();
+            // ֻڵһ֡ȴGPUɣõ֡ͼʱ
+            if (frame == 0) {
+                glFinish();
+                firstFrameTime = chrono::duration<double>(chrono::high_resolution_clock::now() - startTime).count();
+                PrintStartup(loadTime, firstFrameTime);
+            }
+            glfwPollEvents();
         }
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+
+        ofstream output(outputPath);
+        output << "{\n";
+        output << "    \"scenario\": \"" << scenario.name << "\",\n";
+        output << "    \"renderer\": \"" << glGetString(GL_RENDERER) << "\",\n";
+        output << "    \"width\": " << scenario.width << ",\n";
+        output << "    \"height\": " << scenario.height << ",\n";
+        output << "    \"gameModel\": " << scenario.gameModel << ",\n";
+        output << "    \"maxNumber\": " << scenario.maxNumber << ",\n";
+        output << "    \"ballRenderer\": \"" << (scenario.ballRenderer == 2 ? "impostor" : "mesh") << "\",\n";
+        output << "    \"seed\": " << scenario.seed << ",\n";
+        output << "    \"frames\": " << timer.GetFrameCount() << ",\n";
+        output << "    \"gameOver\": " << (isOver ? "true" : "false") << ",\n";
+        output << "    \"score\": " << world.GetScore() << ",\n";
+        SpawnStats spawnStats = world.GetSpawnStats();
+        output << "    \"spawn\": { \"attempts\": " << spawnStats.attempts
+            << ", \"spawned\": " << spawnStats.spawned
+            << ", \"failures\": " << spawnStats.failures << " },\n";
+        output << "    \"startup\": { \"loadMs\": " << loadTime * 1000.0
+            << ", \"firstFrameMs\": " << firstFrameTime * 1000.0 << " },\n";
+        RenderStateStats stateStats = world.GetStateStats();
+        output << "    \"stateChanges\": { \"issuedPerFrame\": " << stateStats.issued
+            << ", \"elidedPerFrame\": " << stateStats.elided << " },\n";
+        output << "    \"resources\": ";
+        world.WriteResourceJson(output);
+        output << ",\n";
+        output << "    \"timing\": ";
+        timer.WriteJson(output);
+        output << "\n}\n";
+        cout << "Benchmark report written to " << outputPath << endl;
     }
+
+    glDeleteRenderbuffers(1, &colorBuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+    glDeleteFramebuffers(1, &fbo);
     glfwTerminate();
-    cout << "----------------------------ĵ÷Ϊ" << world.GetScore() << " ----------------------------" << endl;
     return 0;
 }
 
-void OpenWindow() {
+// 󽻵ԣֱ1k100k1MϱȽϱSSEAVX汾
+int RunRaycastBenchmark() {
+    typedef float (*Kernel)(vec3, vec3, const float*, const float*, const float*, GLuint, float, bool, vector<GLuint>&);
+    const char* names[] = { "scalar", "sse", "avx" };
+    Kernel kernels[] = { RaySphereScalar, RaySphereSSE, RaySphereAVX };
+    bool supported[] = { true, true, IsAvxSupported() };
+    const GLuint counts[] = { 1000, 100000, 1000000 };
+    const GLuint TESTS = 50000000;                          // ÿԼ󽻴
+
+    srand(0);
+    for (GLuint c = 0; c < 3; c++) {
+        GLuint count = counts[c];
+        vector<float> x(count), y(count), z(count);
+        for (GLuint i = 0; i < count; i++) {
+            x[i] = rand() % 200 - 100.0f;
+            y[i] = rand() % 60 + 5.0f;
+            z[i] = rand() % 170 - 85.0f;
+        }
+        vector<GLuint> hits;
+        hits.reserve(count);
+        GLuint rays = std::max<GLuint>(TESTS / count, 1);
+
+        for (GLuint k = 0; k < 3; k++) {
+            if (!supported[k]) {
+                cout << "spheres: " << count << "\t" << names[k] << "\tnot supported by this CPU" << endl;
+                continue;
+            }
+            GLuint hitCount = 0;
+            auto start = chrono::high_resolution_clock::now();
+            for (GLuint r = 0; r < rays; r++) {
+                float angle = r * 0.001f;
+                vec3 dir = normalize(vec3(sin(angle), 0.1f, -cos(angle)));
+                kernels[k](vec3(0.0, 10.0, 70.0), dir, &x[0], &y[0], &z[0], count, HITRADIUS, true, hits);
+                hitCount += hits.size();
+            }
+            double seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+            cout << "spheres: " << count << "\t" << names[k] << "\t"
+                << (double)count * rays / seconds / 1000000.0 << " M spheres/s\t(hits: " << hitCount << ")" << endl;
+        }
+    }
+    return 0;
+}
+
+// ʱںԴʱ䣬Լһ֡ɵʱ
+void PrintStartup(double loadTime, double firstFrameTime) {
+    cout << "Startup: load " << loadTime * 1000.0 << " ms, time to first frame " << firstFrameTime * 1000.0 << " ms" << endl;
+}
+
+void OpenWindow(int width, int height, bool visible, int contextApi) {
     const char* TITLE = "Shoot Game";
-    int WIDTH = 1960;
-    int HEIGHT = 1080;
+    int WIDTH = width;
+    int HEIGHT = height;
 
     // ʼGLFW
     if (!glfwInit()) {
@@ -78,6 +288,8 @@ void OpenWindow() {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_REFRESH_RATE, 60);
+    glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, contextApi);
 
     window = glfwCreateWindow(WIDTH, HEIGHT, TITLE, NULL, NULL);
     if (window == NULL) {
@@ -97,13 +309,14 @@ void OpenWindow() {
 
     glGetError();
 
+    Shader::EnableParallelCompile((GLADloadproc)glfwGetProcAddress);
+
     windowSize = vec2(WIDTH, HEIGHT);
 }
 
 void PrepareOpenGL() {
-    // ȲԺͻ
+    // Ȳԣǲ͸壬ɸʵĹ״̬RenderState
     glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // ѱΪɫ
@@ -0,0 +1,116 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+using namespace std;
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// ֻʽļӳ䵽ڴ棬ʱӳ
+class MappedFile {
+private:
+	const unsigned char* data;
+	size_t size;
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE mapping;
+#else
+	int file;
+#endif
+public:
+	MappedFile() {
+		data = NULL;
+		size = 0;
+#ifdef _WIN32
+		file = INVALID_HANDLE_VALUE;
+		mapping = NULL;
+#else
+		file = -1;
+#endif
+	}
+
+	~MappedFile() {
+		Close();
+	}
+
+	bool Open(const string& path) {
+		Close();
+#ifdef _WIN32
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+			Close();
+			return false;
+		}
+		size = (size_t)fileSize.QuadPart;
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL) {
+			Close();
+			return false;
+		}
+		data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+		file = open(path.c_str(), O_RDONLY);
+		if (file == -1)
+			return false;
+		struct stat info;
+		if (fstat(file, &info) != 0 || info.st_size == 0) {
+			Close();
+			return false;
+		}
+		size = (size_t)info.st_size;
+		void* address = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+		data = address == MAP_FAILED ? NULL : (const unsigned char*)address;
+#endif
+		if (data == NULL) {
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void Close() {
+#ifdef _WIN32
+		if (data != NULL)
+			UnmapViewOfFile(data);
+		if (mapping != NULL)
+			CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+		mapping = NULL;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (data != NULL)
+			munmap((void*)data, size);
+		if (file != -1)
+			close(file);
+		file = -1;
+#endif
+		data = NULL;
+		size = 0;
+	}
+
+	const unsigned char* GetData() {
+		return data;
+	}
+
+	size_t GetSize() {
+		return size;
+	}
+};
+
+#endif // !MAPPEDFILE_H
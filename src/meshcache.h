@@ -0,0 +1,129 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include <glad/glad.h>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+using namespace std;
+#include "mappedfile.h"
+
+const char MESHCACHEMAGIC[4] = { 'S', 'G', 'M', 'C' };
+const GLuint MESHCACHEVERSION = 5;		// ʽ뷽ʽıʱӣɻԶʧЧ
+
+// ĻƷΧbaseVertexglDrawElementsBaseVertex
+struct Submesh {
+	GLint baseVertex;					// һڶ㻺еλ
+	GLuint firstIndex;					// һеλ
+	GLuint count;						// Ŀ
+	GLuint material;					// 
+};
+
+// 񻺴ļͷǽŵĶݡݣ뵽4ֽڣ
+struct MeshCacheHeader {
+	char magic[4];
+	GLuint version;
+	uint64_t sourceHash;				// ԴļݵĹϣԴļı󻺴ʧЧ
+	GLuint vertexCount;
+	GLuint vertexStride;				// ÿֽ
+	GLuint indexCount;
+	GLuint indexSize;					// ÿֽ24
+	GLuint submeshCount;				// LODĿ֮
+	GLuint lodCount;					// LODÿδ
+	GLuint format;						// ʵʹõĶʽ
+	float positionOffset[3];			// 뾫λõƽƺ
+	float positionScale;
+	GLuint reserved;
+};
+
+// 񻺴棺һʱassimp벢д뻺棬ֱ֮ӳ仺ļglBufferData
+class MeshCache {
+public:
+	// ԴģͶӦĻļ·ͬĶʽLODֿ
+	static string GetCachePath(const string& path, GLuint format, GLuint lodCount) {
+		if (format == 0 && lodCount == 1)
+			return path + ".mesh";
+		return path + "." + to_string(format) + "." + to_string(lodCount) + ".mesh";
+	}
+	// ļݵFNV-1aϣļʱ0
+	static uint64_t HashFile(const string& path) {
+		ifstream file(path, ios::binary);
+		if (!file)
+			return 0;
+		uint64_t hash = 14695981039346656037ULL;
+		char buffer[65536];
+		while (file) {
+			file.read(buffer, sizeof(buffer));
+			streamsize count = file.gcount();
+			for (streamsize i = 0; i < count; i++) {
+				hash ^= (unsigned char)buffer[i];
+				hash *= 1099511628211ULL;
+			}
+		}
+		return hash;
+	}
+	// ӳ仺ļУ飬治ڡ汾ԴļѸıʱNULL
+	static const MeshCacheHeader* Open(const string& path, uint64_t sourceHash, MappedFile& file) {
+		if (sourceHash == 0 || !file.Open(path))
+			return NULL;
+		if (file.GetSize() < sizeof(MeshCacheHeader))
+			return NULL;
+
+		const MeshCacheHeader* header = (const MeshCacheHeader*)file.GetData();
+		if (memcmp(header->magic, MESHCACHEMAGIC, 4) != 0 || header->version != MESHCACHEVERSION || header->sourceHash != sourceHash)
+			return NULL;
+		if (header->indexSize != 2 && header->indexSize != 4)
+			return NULL;
+		if (header->lodCount == 0 || header->submeshCount % header->lodCount != 0)
+			return NULL;
+		size_t expected = sizeof(MeshCacheHeader) + (size_t)header->vertexCount * header->vertexStride
+			+ GetIndexBytes(header->indexCount, header->indexSize) + (size_t)header->submeshCount * sizeof(Submesh);
+		if (file.GetSize() != expected)
+			return NULL;
+		return header;
+	}
+
+	static const void* GetVertices(const MeshCacheHeader* header) {
+		return (const unsigned char*)header + sizeof(MeshCacheHeader);
+	}
+
+	static const void* GetIndices(const MeshCacheHeader* header) {
+		return (const unsigned char*)GetVertices(header) + (size_t)header->vertexCount * header->vertexStride;
+	}
+
+	static const Submesh* GetSubmeshes(const MeshCacheHeader* header) {
+		return (const Submesh*)((const unsigned char*)GetIndices(header) + GetIndexBytes(header->indexCount, header->indexSize));
+	}
+	// headerеĶϢɵ
+	static bool Save(const string& path, MeshCacheHeader header, const void* vertices, const void* indices, const vector<Submesh>& submeshes) {
+		if (header.sourceHash == 0)
+			return false;
+		ofstream file(path, ios::binary | ios::trunc);
+		if (!file) {
+			cout << "Mesh cache failed to write at path: " << path << endl;
+			return false;
+		}
+
+		memcpy(header.magic, MESHCACHEMAGIC, 4);
+		header.version = MESHCACHEVERSION;
+		header.submeshCount = submeshes.size();
+		size_t indexBytes = (size_t)header.indexCount * header.indexSize;
+		const char padding[4] = { 0, 0, 0, 0 };
+		file.write((const char*)&header, sizeof(header));
+		file.write((const char*)vertices, (streamsize)header.vertexCount * header.vertexStride);
+		file.write((const char*)indices, indexBytes);
+		file.write(padding, GetIndexBytes(header.indexCount, header.indexSize) - indexBytes);
+		file.write((const char*)&submeshes[0], (streamsize)submeshes.size() * sizeof(Submesh));
+		return file.good();
+	}
+private:
+	// ݲ뵽4ֽڣ֤
+	static size_t GetIndexBytes(GLuint indexCount, GLuint indexSize) {
+		return ((size_t)indexCount * indexSize + 3) & ~(size_t)3;
+	}
+};
+
+#endif // !MESHCACHE_H
@@ -0,0 +1,391 @@
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+using namespace std;
+using namespace glm;
+
+const GLuint VERTEXCACHESIZE = 32;		// 㻺ʱĻС
+const GLuint STATSCACHESIZE = 16;		// ͳACMR/ATVRʱģFIFOС
+const float OVERDRAWTHRESHOLD = 1.05f;	// ȻACMR
+const GLuint MAXLODS = 4;				// ɵLODԭʼ
+const GLuint LODGRIDSIZE = 16;			// 1LODذΧ߻ֵĸ֮ÿ
+
+// 㻺ͳƣACMRΪƽÿεĻδATVRΪƽÿı任Խӽ1Խ
+struct MeshStats {
+	size_t triangles;
+	size_t vertices;
+	size_t misses;
+
+	MeshStats() {
+		triangles = 0;
+		vertices = 0;
+		misses = 0;
+	}
+
+	float GetACMR() {
+		return triangles == 0 ? 0.0f : (float)misses / triangles;
+	}
+
+	float GetATVR() {
+		return vertices == 0 ? 0.0f : (float)misses / vertices;
+	}
+};
+
+// ʱŻͬ㣬㻺͹ȻΣٰȡ˳Ŷ
+// Ϊÿ8floatλáߡ꣩Ϊб
+class MeshOptimizer {
+public:
+	// ִŻ
+	static void Optimize(vector<GLfloat>& vertices, vector<GLuint>& indices) {
+		Weld(vertices, indices);
+		OptimizeVertexCache(indices, vertices.size() / 8);
+		OptimizeOverdraw(indices, vertices);
+		OptimizeVertexFetch(vertices, indices);
+	}
+	// 򻯣Χ߻ΪgridSizeͬһĶϲΪǵƽֵȥ˻ظ
+	static void Simplify(const vector<GLfloat>& vertices, const vector<GLuint>& indices, GLuint gridSize,
+		vector<GLfloat>& outVertices, vector<GLuint>& outIndices) {
+		outVertices.clear();
+		outIndices.clear();
+		size_t vertexCount = vertices.size() / 8;
+		if (vertexCount == 0 || gridSize == 0)
+			return;
+		vec3 minCorner = GetPosition(vertices, 0), maxCorner = minCorner;
+		for (size_t v = 1; v < vertexCount; v++) {
+			minCorner = min(minCorner, GetPosition(vertices, v));
+			maxCorner = max(maxCorner, GetPosition(vertices, v));
+		}
+		vec3 extent = maxCorner - minCorner;
+		float cellSize = glm::max(glm::max(extent.x, extent.y), extent.z) / gridSize;
+		if (cellSize <= 0.0f)
+			return;
+
+		// ÿӵĶ֮붥
+		unordered_map<uint64_t, GLuint> cells;
+		vector<GLuint> remap(vertexCount);
+		vector<GLfloat> sums;
+		vector<GLuint> counts;
+		for (size_t v = 0; v < vertexCount; v++) {
+			ivec3 cell = clamp(ivec3((GetPosition(vertices, v) - minCorner) / cellSize), ivec3(0), ivec3(gridSize - 1));
+			uint64_t key = ((uint64_t)cell.x * gridSize + cell.y) * gridSize + cell.z;
+			auto it = cells.find(key);
+			if (it == cells.end()) {
+				it = cells.insert(make_pair(key, (GLuint)counts.size())).first;
+				sums.resize(sums.size() + 8, 0.0f);
+				counts.push_back(0);
+			}
+			remap[v] = it->second;
+			counts[it->second]++;
+			for (GLuint k = 0; k < 8; k++)
+				sums[it->second * 8 + k] += vertices[v * 8 + k];
+		}
+
+		outVertices.resize(sums.size());
+		for (size_t c = 0; c < counts.size(); c++) {
+			for (GLuint k = 0; k < 8; k++)
+				outVertices[c * 8 + k] = sums[c * 8 + k] / counts[c];
+			vec3 normal(sums[c * 8 + 3], sums[c * 8 + 4], sums[c * 8 + 5]);
+			if (length(normal) > 0.0f) {
+				normal = normalize(normal);
+				outVertices[c * 8 + 3] = normal.x;
+				outVertices[c * 8 + 4] = normal.y;
+				outVertices[c * 8 + 5] = normal.z;
+			}
+		}
+
+		// תСǰȥ
+		unordered_set<uint64_t> triangles;
+		for (size_t t = 0; t < indices.size() / 3; t++) {
+			GLuint a = remap[indices[t * 3]], b = remap[indices[t * 3 + 1]], c = remap[indices[t * 3 + 2]];
+			if (a == b || b == c || a == c)
+				continue;
+			while (a > b || a > c) {
+				GLuint first = a;
+				a = b;
+				b = c;
+				c = first;
+			}
+			if (!triangles.insert(((uint64_t)a << 42) | ((uint64_t)b << 21) | c).second)
+				continue;
+			outIndices.push_back(a);
+			outIndices.push_back(b);
+			outIndices.push_back(c);
+		}
+		OptimizeVertexFetch(outVertices, outIndices);
+	}
+	// FIFOģƣѽۼӵstats
+	static void AddStats(const vector<GLuint>& indices, size_t vertexCount, MeshStats& stats) {
+		vector<GLuint> misses;
+		SimulateCache(indices, vertexCount, misses);
+		stats.triangles += indices.size() / 3;
+		stats.vertices += vertexCount;
+		for (size_t i = 0; i < misses.size(); i++)
+			stats.misses += misses[i];
+	}
+	// ϲзȫͬĶ
+	static void Weld(vector<GLfloat>& vertices, vector<GLuint>& indices) {
+		size_t vertexCount = vertices.size() / 8;
+		unordered_multimap<uint64_t, GLuint> table;
+		table.reserve(vertexCount);
+		vector<GLuint> remap(vertexCount);
+		vector<GLfloat> welded;
+		welded.reserve(vertices.size());
+		for (size_t i = 0; i < vertexCount; i++) {
+			const GLfloat* vertex = &vertices[i * 8];
+			uint64_t hash = Hash(vertex);
+			GLuint index = welded.size() / 8;
+			auto range = table.equal_range(hash);
+			for (auto it = range.first; it != range.second; ++it)
+				if (memcmp(&welded[it->second * 8], vertex, sizeof(GLfloat) * 8) == 0) {
+					index = it->second;
+					break;
+				}
+			if (index == welded.size() / 8) {
+				welded.insert(welded.end(), vertex, vertex + 8);
+				table.insert(make_pair(hash, index));
+			}
+			remap[i] = index;
+		}
+		for (size_t i = 0; i < indices.size(); i++)
+			indices[i] = remap[indices[i]];
+		vertices.swap(welded);
+	}
+	// ForsythķΣÿδӻеĶڵѡ÷ߵһ߶㻺
+	static void OptimizeVertexCache(vector<GLuint>& indices, size_t vertexCount) {
+		size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+			return;
+
+		// ÿڵδΣadjacency[offsets[v], offsets[v] + valence[v])
+		vector<GLuint> valence(vertexCount, 0);
+		for (size_t i = 0; i < indices.size(); i++)
+			valence[indices[i]]++;
+		vector<GLuint> offsets(vertexCount + 1, 0);
+		for (size_t v = 0; v < vertexCount; v++)
+			offsets[v + 1] = offsets[v] + valence[v];
+		vector<GLuint> adjacency(indices.size());
+		vector<GLuint> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++)
+			adjacency[fill[indices[i]]++] = i / 3;
+
+		vector<int> cachePosition(vertexCount, -1);
+		vector<float> vertexScore(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++)
+			vertexScore[v] = GetVertexScore(-1, valence[v]);
+		vector<float> triangleScore(triangleCount);
+		for (size_t t = 0; t < triangleCount; t++)
+			triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+		vector<bool> emitted(triangleCount, false);
+		vector<GLuint> result;
+		result.reserve(indices.size());
+		vector<GLuint> cache, newCache;
+		cache.reserve(VERTEXCACHESIZE + 3);
+		newCache.reserve(VERTEXCACHESIZE + 3);
+		size_t cursor = 0;
+		int best = 0;
+		for (size_t t = 1; t < triangleCount; t++)
+			if (triangleScore[t] > triangleScore[best])
+				best = t;
+
+		while (result.size() < indices.size()) {
+			// еĶ㶼ûʱȡһδ
+			if (best < 0) {
+				while (emitted[cursor])
+					cursor++;
+				best = cursor;
+			}
+			emitted[best] = true;
+			newCache.clear();
+			for (GLuint k = 0; k < 3; k++) {
+				GLuint v = indices[best * 3 + k];
+				result.push_back(v);
+				newCache.push_back(v);
+				GLuint* first = &adjacency[offsets[v]];
+				GLuint* last = first + valence[v];
+				*find(first, last, (GLuint)best) = *(last - 1);
+				valence[v]--;
+			}
+			for (size_t i = 0; i < cache.size(); i++)
+				if (cache[i] != newCache[0] && cache[i] != newCache[1] && cache[i] != newCache[2])
+					newCache.push_back(cache[i]);
+
+			// »λú͵÷֣ĶλΪ-1
+			for (size_t i = 0; i < newCache.size(); i++)
+				cachePosition[newCache[i]] = i < VERTEXCACHESIZE ? i : -1;
+			best = -1;
+			float bestScore = -1.0f;
+			for (size_t i = 0; i < newCache.size(); i++) {
+				GLuint v = newCache[i];
+				float score = GetVertexScore(cachePosition[v], valence[v]);
+				float delta = score - vertexScore[v];
+				vertexScore[v] = score;
+				for (GLuint j = offsets[v]; j < offsets[v] + valence[v]; j++) {
+					GLuint t = adjacency[j];
+					triangleScore[t] += delta;
+					if (i < VERTEXCACHESIZE && triangleScore[t] > bestScore) {
+						bestScore = triangleScore[t];
+						best = t;
+					}
+				}
+			}
+			if (newCache.size() > VERTEXCACHESIZE)
+				newCache.resize(VERTEXCACHESIZE);
+			cache.swap(newCache);
+		}
+		indices.swap(result);
+	}
+	// ηֳɿ飬ĿȻٹȻƣֻڲԽͻʵλ÷ֿ
+	static void OptimizeOverdraw(vector<GLuint>& indices, const vector<GLfloat>& vertices) {
+		size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+			return;
+		vector<GLuint> misses;
+		SimulateCache(indices, vertices.size() / 8, misses);
+
+		// 㶼δеӲ߽硣Ӳ߽ڲӿջ濪ʼģ⣬
+		// ACMRֵʱз֣鵥ʱҲ½
+		vector<size_t> clusters;
+		vector<size_t> stamps(vertices.size() / 8, 0);
+		size_t time = STATSCACHESIZE + 1;
+		size_t start = 0;
+		while (start < triangleCount) {
+			size_t end = start + 1;
+			size_t hardMisses = misses[start];
+			while (end < triangleCount && misses[end] < 3)
+				hardMisses += misses[end++];
+			float threshold = OVERDRAWTHRESHOLD * hardMisses / (end - start);
+
+			size_t clusterStart = start;
+			size_t clusterMisses = 0;
+			time += STATSCACHESIZE + 1;
+			for (size_t t = start; t < end; t++) {
+				for (GLuint k = 0; k < 3; k++) {
+					GLuint v = indices[t * 3 + k];
+					if (time - stamps[v] > STATSCACHESIZE) {
+						stamps[v] = time++;
+						clusterMisses++;
+					}
+				}
+				if (t + 1 < end && (float)clusterMisses / (t + 1 - clusterStart) <= threshold) {
+					clusters.push_back(clusterStart);
+					clusterStart = t + 1;
+					clusterMisses = 0;
+					time += STATSCACHESIZE + 1;
+				}
+			}
+			clusters.push_back(clusterStart);
+			start = end;
+		}
+
+		// ÿֵڿƽϵͶӰԽԽ
+		vec3 meshCenter(0.0f);
+		float meshArea = 0.0f;
+		vector<vec3> centers(clusters.size(), vec3(0.0f));
+		vector<vec3> normals(clusters.size(), vec3(0.0f));
+		vector<float> areas(clusters.size(), 0.0f);
+		for (size_t c = 0; c < clusters.size(); c++) {
+			size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+			for (size_t t = clusters[c]; t < end; t++) {
+				vec3 a = GetPosition(vertices, indices[t * 3]);
+				vec3 b = GetPosition(vertices, indices[t * 3 + 1]);
+				vec3 d = GetPosition(vertices, indices[t * 3 + 2]);
+				vec3 normal = cross(b - a, d - a);
+				float area = length(normal);
+				centers[c] += (a + b + d) * (area / 3.0f);
+				normals[c] += normal;
+				areas[c] += area;
+			}
+			meshCenter += centers[c];
+			meshArea += areas[c];
+		}
+		if (meshArea > 0.0f)
+			meshCenter /= meshArea;
+		vector<float> keys(clusters.size());
+		vector<GLuint> order(clusters.size());
+		for (size_t c = 0; c < clusters.size(); c++) {
+			vec3 center = areas[c] > 0.0f ? centers[c] / areas[c] : meshCenter;
+			float normalLength = length(normals[c]);
+			keys[c] = normalLength > 0.0f ? dot(center - meshCenter, normals[c] / normalLength) : 0.0f;
+			order[c] = c;
+		}
+		stable_sort(order.begin(), order.end(), [&keys](GLuint a, GLuint b) { return keys[a] > keys[b]; });
+
+		vector<GLuint> result;
+		result.reserve(indices.size());
+		for (size_t i = 0; i < order.size(); i++) {
+			size_t c = order[i];
+			size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+			result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + end * 3);
+		}
+		indices.swap(result);
+	}
+	// еһγֵ˳Ŷ㣬ȥûõĶ
+	static void OptimizeVertexFetch(vector<GLfloat>& vertices, vector<GLuint>& indices) {
+		const GLuint UNUSED = 0xFFFFFFFF;
+		vector<GLuint> remap(vertices.size() / 8, UNUSED);
+		vector<GLfloat> result;
+		result.reserve(vertices.size());
+		for (size_t i = 0; i < indices.size(); i++) {
+			GLuint v = indices[i];
+			if (remap[v] == UNUSED) {
+				remap[v] = result.size() / 8;
+				result.insert(result.end(), vertices.begin() + v * 8, vertices.begin() + v * 8 + 8);
+			}
+			indices[i] = remap[v];
+		}
+		vertices.swap(result);
+	}
+private:
+	// ForsythĶ÷֣ùĶʣٵĶ÷ָ
+	static float GetVertexScore(int cachePosition, GLuint valence) {
+		if (valence == 0)
+			return -1.0f;
+		float score = 0.0f;
+		if (cachePosition >= 0) {
+			if (cachePosition < 3)
+				score = 0.75f;
+			else
+				score = pow(1.0f - (float)(cachePosition - 3) / (VERTEXCACHESIZE - 3), 1.5f);
+		}
+		return score + 2.0f / sqrt((float)valence);
+	}
+	// ģFIFO棬¼ÿεδ
+	static void SimulateCache(const vector<GLuint>& indices, size_t vertexCount, vector<GLuint>& misses) {
+		// 뻺ʱ̣뵱ǰʱСʱڻ
+		vector<size_t> stamps(vertexCount, 0);
+		size_t time = STATSCACHESIZE + 1;
+		misses.assign(indices.size() / 3, 0);
+		for (size_t i = 0; i < indices.size(); i++) {
+			GLuint v = indices[i];
+			if (time - stamps[v] > STATSCACHESIZE) {
+				stamps[v] = time++;
+				misses[i / 3]++;
+			}
+		}
+	}
+
+	static vec3 GetPosition(const vector<GLfloat>& vertices, GLuint index) {
+		return vec3(vertices[index * 8], vertices[index * 8 + 1], vertices[index * 8 + 2]);
+	}
+	// 8floatFNV-1aϣ
+	static uint64_t Hash(const GLfloat* vertex) {
+		const unsigned char* bytes = (const unsigned char*)vertex;
+		uint64_t hash = 14695981039346656037ULL;
+		for (size_t i = 0; i < sizeof(GLfloat) * 8; i++) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+};
+
+#endif // !MESHOPTIMIZER_H
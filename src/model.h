@@ -4,31 +4,210 @@
 #include <glad/glad.h>
 #include <string>
 #include <iostream>
+#include <sstream>
 #include <vector>
 using namespace std;
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 using namespace Assimp;
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+using namespace glm;
+#include "meshcache.h"
+#include "vertexformat.h"
+#include "meshoptimizer.h"
+
+// ͶӰ뾶أСLODPIXELS[i]ʱʹõiLODӰͼøֵSHADOWLODPIXELS
+const float LODPIXELS[MAXLODS - 1] = { 48.0f, 20.0f, 8.0f };
+const float SHADOWLODPIXELS[MAXLODS - 1] = { 96.0f, 40.0f, 16.0f };
 
 class Model {
 private:
     vector<GLfloat> vertices;           // 
-    vector<GLuint> indices;             // 
+    vector<GLuint> indices;             // ÿ0ʼ
+    vector<Submesh> submeshes;          // ĻƷΧLODδ
+    GLuint lodCount;                    // LOD0Ϊԭʼ
+    GLuint indexCount;                  // Ŀ
+    GLenum indexType;                   // 65536ʱʹ16λ
+    GLuint indexSize;
+    GLuint format;                      // ʵʹõĶʽ
+    mat4 positionTransform;             // 뾫λûԭģͿռı任
     GLuint VAO;                         // ģ͵Ļ
+    GLuint VBO;
+    GLuint EBO;
+    size_t gpuBytes;                    // ռõԴ
+    bool keepData;                      // ϴǷδѹ
+
+    // Load׼áȴUploadϴݣָ򻺴ӳѹ
+    MappedFile cacheFile;
+    vector<unsigned char> packedVertices;
+    vector<GLushort> shortIndices;
+    const void* pendingVertices;
+    size_t pendingVertexBytes;
+    const void* pendingIndices;
+    string report;                      // LoadеŻUploadOpenGL߳дӡ̵߳
 public:
-    Model(const string& path) {
+    // ֻʼ֮LoadȡݡUploadϴں̨
+    Model() {
+        Init(PACKNONE, 1, false);
+    }
+    // formatΪѹѡvertexformat.hlodCountΪʱɵLODMAXLODS
+    // keepDataΪtrueʱϴδѹĶ飬ͷţֻGPU
+    Model(const string& path, GLuint format = PACKNONE, GLuint lodCount = 1, bool keepData = false) {
+        Load(path, format, lodCount, keepData);
+        Upload();
+    }
+    // ʹڴеݣɵ壩ȡļҲд棻submeshesиLODδ
+    Model(const vector<GLfloat>& vertices, const vector<GLuint>& indices, const vector<Submesh>& submeshes,
+        GLuint lodCount = 1, GLuint format = PACKNONE, bool keepData = false) {
+        Init(format, lodCount, keepData);
+        this->vertices = vertices;
+        this->indices = indices;
+        this->submeshes = submeshes;
+        if (this->vertices.empty() || this->indices.empty())
+            return;
+        MeshCacheHeader header;
+        memset(&header, 0, sizeof(header));
+        Pack(header, "");
+        Upload();
+    }
+
+    ~Model() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+    }
+
+    // ȡģͲѹOpenGLڹִ߳
+    void Load(const string& path, GLuint format = PACKNONE, GLuint lodCount = 1, bool keepData = false) {
+        Init(format, lodCount, keepData);
+        // ʹû棬ֱӳ䵽ڴ潻OpenGLassimp
+        MeshCacheHeader header;
+        memset(&header, 0, sizeof(header));
+        header.sourceHash = MeshCache::HashFile(path);
+        string cachePath = MeshCache::GetCachePath(path, format, this->lodCount);
+        const MeshCacheHeader* cached = MeshCache::Open(cachePath, header.sourceHash, cacheFile);
+        if (cached != NULL) {
+            const Submesh* first = MeshCache::GetSubmeshes(cached);
+            submeshes.assign(first, first + cached->submeshCount);
+            this->lodCount = cached->lodCount;
+            SetFormat(*cached);
+            pendingVertices = MeshCache::GetVertices(cached);
+            pendingVertexBytes = (size_t)cached->vertexCount * cached->vertexStride;
+            pendingIndices = MeshCache::GetIndices(cached);
+            indexCount = cached->indexCount;
+            if (keepData) {
+                VertexFormat::Unpack(MeshCache::GetVertices(cached), cached->vertexCount, cached->format,
+                    vec3(cached->positionOffset[0], cached->positionOffset[1], cached->positionOffset[2]), cached->positionScale, vertices);
+                indices.resize(cached->indexCount);
+                for (GLuint i = 0; i < cached->indexCount; i++)
+                    indices[i] = indexSize == 2 ? ((const GLushort*)MeshCache::GetIndices(cached))[i] : ((const GLuint*)MeshCache::GetIndices(cached))[i];
+            }
+            return;
+        }
+
         LoadModel(path);
-        SetVAO();
+        if (vertices.empty() || indices.empty())
+            return;
+        Pack(header, cachePath);
+    }
+    // Load׼õϴOpenGL̵߳ã֮ͷŵȴϴ
+    void Upload() {
+        cout << report;
+        report.clear();
+        if (pendingVertices != NULL)
+            SetVAO(pendingVertices, pendingVertexBytes, pendingIndices, indexCount);
+        pendingVertices = NULL;
+        pendingIndices = NULL;
+        vector<unsigned char>().swap(packedVertices);
+        vector<GLushort>().swap(shortIndices);
+        cacheFile.Close();
+        if (!keepData) {
+            vector<GLfloat>().swap(vertices);
+            vector<GLuint>().swap(indices);
+        }
     }
 
     GLuint GetVAO() {
         return VAO;
     }
+    // ½һģͶVAOڵԼĶԣʵݣɵ߸ɾ
+    GLuint CreateVAO() {
+        GLuint vao;
+        glGenVertexArrays(1, &vao);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        SetAttributes();
+        glBindVertexArray(0);
+        return vao;
+    }
+
+    GLuint GetIndexCount() {
+        return indexCount;
+    }
+    // ڵǰ󶨵VAOϻƵlod
+    void Draw(GLuint lod = 0) {
+        GLuint meshCount = submeshes.size() / lodCount;
+        for (size_t i = lod * meshCount; i < (lod + 1) * meshCount; i++)
+            glDrawElementsBaseVertex(GL_TRIANGLES, submeshes[i].count, indexType,
+                (void*)((size_t)indexSize * submeshes[i].firstIndex), submeshes[i].baseVertex);
+    }
+    // ڵǰ󶨵VAOϻƵlodĶʵ
+    void DrawInstanced(GLsizei instanceCount, GLuint lod = 0) {
+        GLuint meshCount = submeshes.size() / lodCount;
+        for (size_t i = lod * meshCount; i < (lod + 1) * meshCount; i++)
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, submeshes[i].count, indexType,
+                (void*)((size_t)indexSize * submeshes[i].firstIndex), instanceCount, submeshes[i].baseVertex);
+    }
 
-    vector<GLuint> GetIndices() {
+    GLuint GetLodCount() {
+        return lodCount;
+    }
+    // ͶӰ뾶أѡLODthresholdsϸУLODPIXELS
+    GLuint SelectLod(float radiusPixels, const float* thresholds) {
+        GLuint lod = 0;
+        while (lod + 1 < lodCount && radiusPixels < thresholds[lod])
+            lod++;
+        return lod;
+    }
+
+    GLuint GetTriangleCount(GLuint lod = 0) {
+        GLuint meshCount = submeshes.size() / lodCount;
+        GLuint count = 0;
+        for (size_t i = lod * meshCount; i < (lod + 1) * meshCount; i++)
+            count += submeshes[i].count / 3;
+        return count;
+    }
+    // Ҫģ;ұߵı任ֻа뾫λòǵλʵʱʵλò任˲ʹð뾫λ
+    mat4 GetPositionTransform() {
+        return positionTransform;
+    }
+
+    GLuint GetFormat() {
+        return format;
+    }
+
+    const vector<Submesh>& GetSubmeshes() {
+        return submeshes;
+    }
+    // Ķݣÿ8floatʱkeepDataΪfalseΪ
+    const vector<GLfloat>& GetVertices() {
+        return vertices;
+    }
+
+    const vector<GLuint>& GetIndices() {
         return indices;
     }
+
+    size_t GetCpuBytes() {
+        return vertices.capacity() * sizeof(GLfloat) + indices.capacity() * sizeof(GLuint);
+    }
+
+    size_t GetGpuBytes() {
+        return gpuBytes;
+    }
 private:
     // ļģͣʹassimp
     void LoadModel(const string& path) {
@@ -36,10 +215,74 @@ private:
         const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals);
 
         if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-            cout << "ERROR::ASSIMP::" << importer.GetErrorString() << endl;
+            report += string("ERROR::ASSIMP::") + importer.GetErrorString() + "\n";
             return;
         }
         ProcessNode(scene->mRootNode, scene);
+        OptimizeMeshes(path);
+        GenerateLods(path);
+    }
+    // ö𼶼򻯵0ÿ񣬽׷ں棻򻯺Ϊʱһ
+    void GenerateLods(const string& path) {
+        GLuint meshCount = submeshes.size();
+        size_t baseVertexCount = vertices.size() / 8;
+        if (lodCount == 1 || meshCount == 0)
+            return;
+        for (GLuint lod = 1; lod < lodCount; lod++) {
+            for (GLuint i = 0; i < meshCount; i++) {
+                Submesh submesh = submeshes[i];
+                size_t vertexEnd = i + 1 < meshCount ? submeshes[i + 1].baseVertex : baseVertexCount;
+                vector<GLfloat> meshVertices(vertices.begin() + submesh.baseVertex * 8, vertices.begin() + vertexEnd * 8);
+                vector<GLuint> meshIndices(indices.begin() + submesh.firstIndex, indices.begin() + submesh.firstIndex + submesh.count);
+                vector<GLfloat> lodVertices;
+                vector<GLuint> lodIndices;
+                MeshOptimizer::Simplify(meshVertices, meshIndices, LODGRIDSIZE >> (lod - 1), lodVertices, lodIndices);
+                if (lodIndices.empty()) {
+                    submeshes.push_back(submeshes[(lod - 1) * meshCount + i]);
+                    continue;
+                }
+                MeshOptimizer::Optimize(lodVertices, lodIndices);
+                submesh.baseVertex = vertices.size() / 8;
+                submesh.firstIndex = indices.size();
+                submesh.count = lodIndices.size();
+                vertices.insert(vertices.end(), lodVertices.begin(), lodVertices.end());
+                indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+                submeshes.push_back(submesh);
+            }
+        }
+        ostringstream line;
+        line << "Mesh LODs: " << path << "\ttriangles";
+        for (GLuint lod = 0; lod < lodCount; lod++)
+            line << (lod == 0 ? " " : " / ") << GetTriangleCount(lod);
+        line << "\n";
+        report += line.str();
+    }
+    // ӺţŻǰĶͻͳ
+    void OptimizeMeshes(const string& path) {
+        MeshStats before, after;
+        vector<GLfloat> optimizedVertices;
+        vector<GLuint> optimizedIndices;
+        for (size_t i = 0; i < submeshes.size(); i++) {
+            Submesh& submesh = submeshes[i];
+            size_t vertexEnd = i + 1 < submeshes.size() ? submeshes[i + 1].baseVertex : vertices.size() / 8;
+            vector<GLfloat> meshVertices(vertices.begin() + submesh.baseVertex * 8, vertices.begin() + vertexEnd * 8);
+            vector<GLuint> meshIndices(indices.begin() + submesh.firstIndex, indices.begin() + submesh.firstIndex + submesh.count);
+            MeshOptimizer::AddStats(meshIndices, meshVertices.size() / 8, before);
+            MeshOptimizer::Optimize(meshVertices, meshIndices);
+            MeshOptimizer::AddStats(meshIndices, meshVertices.size() / 8, after);
+
+            submesh.baseVertex = optimizedVertices.size() / 8;
+            submesh.firstIndex = optimizedIndices.size();
+            optimizedVertices.insert(optimizedVertices.end(), meshVertices.begin(), meshVertices.end());
+            optimizedIndices.insert(optimizedIndices.end(), meshIndices.begin(), meshIndices.end());
+        }
+        vertices.swap(optimizedVertices);
+        indices.swap(optimizedIndices);
+        ostringstream line;
+        line << "Mesh optimized: " << path << "\tvertices " << before.vertices << " -> " << after.vertices
+            << "\tACMR " << before.GetACMR() << " -> " << after.GetACMR()
+            << "\tATVR " << before.GetATVR() << " -> " << after.GetATVR() << "\n";
+        report += line.str();
     }
     // нڵв
     void ProcessNode(aiNode* node, const aiScene* scene) {
@@ -56,6 +299,11 @@ private:
     }
     // Խڵев
     void ProcessMesh(aiMesh* mesh, const aiScene* scene) {
+        Submesh submesh;
+        submesh.baseVertex = vertices.size() / 8;
+        submesh.firstIndex = indices.size();
+        submesh.material = mesh->mMaterialIndex;
+
         // Ķ
         for (GLuint i = 0; i < mesh->mNumVertices; i++) {
             // λ
@@ -86,32 +334,97 @@ private:
             for (GLuint j = 0; j < face.mNumIndices; j++)
                 indices.push_back(face.mIndices[j]);
         }
+        submesh.count = indices.size() - submesh.firstIndex;
+        submeshes.push_back(submesh);
+    }
+    void Init(GLuint format, GLuint lodCount, bool keepData) {
+        this->lodCount = glm::clamp<GLuint>(lodCount, 1, MAXLODS);
+        this->keepData = keepData;
+        indexCount = 0;
+        indexType = GL_UNSIGNED_INT;
+        indexSize = sizeof(GLuint);
+        this->format = format;
+        positionTransform = mat4(1.0);
+        VAO = VBO = EBO = 0;
+        gpuBytes = 0;
+        pendingVertices = NULL;
+        pendingVertexBytes = 0;
+        pendingIndices = NULL;
+    }
+    // ʽѹȴUploadϴcachePathΪʱͬʱд뻺
+    void Pack(MeshCacheHeader header, const string& cachePath) {
+        // ʽѹ㣬뾫λü¼Χеƽƺ
+        header.format = VertexFormat::Resolve(format, vertices);
+        vec3 offset(0.0f);
+        float scale = 1.0f;
+        if (header.format & PACKHALFPOSITION)
+            VertexFormat::GetPositionBounds(vertices, offset, scale);
+        // ѹʱֱϴԭ
+        const void* vertexData = &vertices[0];
+        if (header.format != PACKNONE) {
+            VertexFormat::Pack(vertices, header.format, offset, scale, packedVertices);
+            vertexData = &packedVertices[0];
+        }
+        header.vertexCount = vertices.size() / 8;
+        header.lodCount = this->lodCount;
+        header.vertexStride = VertexFormat::GetStride(header.format);
+        header.positionOffset[0] = offset.x;
+        header.positionOffset[1] = offset.y;
+        header.positionOffset[2] = offset.z;
+        header.positionScale = scale;
+
+        // 0ʼС65536ʱʹ16λ
+        GLuint maxIndex = 0;
+        for (size_t i = 0; i < indices.size(); i++)
+            maxIndex = std::max(maxIndex, indices[i]);
+        const void* indexData = &indices[0];
+        header.indexCount = indices.size();
+        header.indexSize = sizeof(GLuint);
+        if (maxIndex <= 0xFFFF) {
+            shortIndices.assign(indices.begin(), indices.end());
+            indexData = &shortIndices[0];
+            header.indexSize = sizeof(GLushort);
+        }
+
+        SetFormat(header);
+        if (!cachePath.empty())
+            MeshCache::Save(cachePath, header, vertexData, indexData, submeshes);
+        pendingVertices = vertexData;
+        pendingVertexBytes = (size_t)header.vertexCount * header.vertexStride;
+        pendingIndices = indexData;
+        indexCount = header.indexCount;
+    }
+    // ¼ʽͺλûԭ任
+    void SetFormat(const MeshCacheHeader& header) {
+        format = header.format;
+        indexSize = header.indexSize;
+        indexType = indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        positionTransform = translate(mat4(1.0), vec3(header.positionOffset[0], header.positionOffset[1], header.positionOffset[2]));
+        positionTransform = scale(positionTransform, vec3(header.positionScale));
     }
     // ȡģ뻺ںʹ
-    void SetVAO() {
-        GLuint VBO, EBO;
+    void SetVAO(const void* vertexData, size_t vertexBytes, const void* indexData, GLuint indexCount) {
+        this->indexCount = indexCount;
+        this->gpuBytes = vertexBytes + (size_t)indexSize * indexCount;
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
         glGenBuffers(1, &EBO);
 
         glBindVertexArray(VAO);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * vertices.size(), &vertices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertexData, GL_STATIC_DRAW);
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indices.size(), &indices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (size_t)indexSize * indexCount, indexData, GL_STATIC_DRAW);
 
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 8, (void*)0);
-
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 8, (void*)(3 * sizeof(GLfloat)));
-
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 8, (void*)(6 * sizeof(GLfloat)));
+        SetAttributes();
 
         glBindVertexArray(0);
     }
+    // õǰVAOĶԣλáߡ
+    void SetAttributes() {
+        VertexFormat::SetAttributes(format);
+    }
 };
 
 
@@ -0,0 +1,154 @@
+#ifndef PASSTIMER_H
+#define PASSTIMER_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+using namespace std;
+
+// ¼ÿһ֡иȾ׶εCPUʱGPUʱ룩
+// ͬһ׶һ֡пԼʱΣʱӣÿμʱҲͬʱһ׶
+class PassTimer {
+private:
+	struct Pass {
+		string name;
+		bool active;					// ֡Ƿִйý׶
+		double frameCpu;				// ֡ۼƵCPUʱ
+		vector<GLuint> frameQueries;	// ֡μʱĲѯ
+		vector<double> cpuTimes;
+		vector<double> gpuTimes;
+	};
+	vector<Pass> passes;
+	vector<GLuint> queries;				// GL_TIME_ELAPSEDѯÿ֡ͷظʹ
+	GLuint usedQueries;
+	int current;						// ڼʱĽ׶Σ-1ʾû
+	int parent;							// ͬʱһ׶Σ-1ʾû
+	GLuint query;
+	double cpuStart;
+	double frameStart;
+	vector<double> frameTimes;			// ֡ʱ
+public:
+	PassTimer() {
+		usedQueries = 0;
+		current = -1;
+		parent = -1;
+		query = 0;
+		cpuStart = 0.0;
+		frameStart = 0.0;
+	}
+
+	~PassTimer() {
+		if (!queries.empty())
+			glDeleteQueries(queries.size(), &queries[0]);
+	}
+
+	void BeginFrame() {
+		frameStart = glfwGetTime();
+	}
+	// ȡر֡вѯ׶ӣѯǰ
+	void EndFrame() {
+		for (GLuint i = 0; i < passes.size(); i++) {
+			if (!passes[i].active)
+				continue;
+			double gpuTime = 0.0;
+			for (GLuint j = 0; j < passes[i].frameQueries.size(); j++) {
+				GLuint64 elapsed = 0;
+				glGetQueryObjectui64v(passes[i].frameQueries[j], GL_QUERY_RESULT, &elapsed);
+				gpuTime += elapsed / 1000000.0;
+			}
+			passes[i].cpuTimes.push_back(passes[i].frameCpu);
+			passes[i].gpuTimes.push_back(gpuTime);
+			passes[i].frameCpu = 0.0;
+			passes[i].frameQueries.clear();
+			passes[i].active = false;
+		}
+		usedQueries = 0;
+		frameTimes.push_back((glfwGetTime() - frameStart) * 1000.0);
+	}
+	// ʼһμʱparentΪʱʱҲý׶ΣGL_TIME_ELAPSEDѯǶ
+	void Begin(const char* name, const char* parent = NULL) {
+		current = FindPass(name);
+		this->parent = parent != NULL ? FindPass(parent) : -1;
+		if (usedQueries == queries.size()) {
+			GLuint id;
+			glGenQueries(1, &id);
+			queries.push_back(id);
+		}
+		query = queries[usedQueries++];
+		cpuStart = glfwGetTime();
+		glBeginQuery(GL_TIME_ELAPSED, query);
+	}
+
+	void End() {
+		if (current == -1)
+			return;
+		glEndQuery(GL_TIME_ELAPSED);
+		double cpuTime = (glfwGetTime() - cpuStart) * 1000.0;
+		Record(current, cpuTime);
+		if (parent != -1)
+			Record(parent, cpuTime);
+		current = -1;
+		parent = -1;
+	}
+
+	GLuint GetFrameCount() {
+		return frameTimes.size();
+	}
+	// JSONʽÿ׶εmin/avg/p99
+	void WriteJson(ostream& out) {
+		out << "{\n";
+		out << "        \"frame\": ";
+		WriteStats(out, frameTimes);
+		out << ",\n        \"passes\": {";
+		for (GLuint i = 0; i < passes.size(); i++) {
+			out << (i == 0 ? "\n" : ",\n");
+			out << "            \"" << passes[i].name << "\": { \"cpu\": ";
+			WriteStats(out, passes[i].cpuTimes);
+			out << ", \"gpu\": ";
+			WriteStats(out, passes[i].gpuTimes);
+			out << " }";
+		}
+		out << "\n        }\n    }";
+	}
+private:
+	int FindPass(const char* name) {
+		for (GLuint i = 0; i < passes.size(); i++)
+			if (passes[i].name == name)
+				return i;
+
+		Pass pass;
+		pass.name = name;
+		pass.active = false;
+		pass.frameCpu = 0.0;
+		passes.push_back(pass);
+		return passes.size() - 1;
+	}
+	// ѵǰμʱӵindex׶
+	void Record(int index, double cpuTime) {
+		passes[index].frameCpu += cpuTime;
+		passes[index].frameQueries.push_back(query);
+		passes[index].active = true;
+	}
+
+	void WriteStats(ostream& out, vector<double> samples) {
+		if (samples.empty()) {
+			out << "{ \"min\": 0, \"avg\": 0, \"p99\": 0 }";
+			return;
+		}
+		sort(samples.begin(), samples.end());
+		double sum = 0.0;
+		for (GLuint i = 0; i < samples.size(); i++)
+			sum += samples[i];
+		// ȷ99ٷλ
+		GLuint rank = (GLuint)ceil(samples.size() * 0.99);
+		out << "{ \"min\": " << samples[0]
+			<< ", \"avg\": " << sum / samples.size()
+			<< ", \"p99\": " << samples[rank - 1] << " }";
+	}
+};
+
+#endif // !PASSTIMER_H
@@ -6,103 +6,95 @@
 #include "texture.h"
 #include "shader.h"
 #include "camera.h"
+#include "resourcemanager.h"
+#include "renderqueue.h"
+
+const float SUNRADIUS = 15.0f;			// ̫İ뾶
+const GLuint ROOMFEATURES = SHADERSHADOWS | SHADERSPECULAR | SHADERPHONG | SHADERTEXTURED | SHADERNORMALMATRIX;	// ɫı
 
 class Place {
 private:
 	vec2 windowSize;
 	// 
-	Model* room;
-	Texture* roomTexture;
-	Shader* roomShader;
+	shared_ptr<Model> room;
+	shared_ptr<Texture> roomTexture;
+	shared_ptr<Shader> roomShader;
+	PipelineState roomPipeline;
 
 	// ̫
-	Model* sun;
-	vec3 lightPos;							// Դλ
-	mat4 lightSpaceMatrix;					// תΪԹԴΪĵ
-	Shader* sunShader;
+	shared_ptr<Model> sun;
+	shared_ptr<Shader> sunShader;
+	PipelineState sunPipeline;
 
 	Camera* camera;
+	ResourceManager* resources;
 	// ģͱ任
 	mat4 model;
-	mat4 projection;
-	mat4 view;
 public:
-	Place(vec2 windowSize, Camera* camera) {
+	Place(vec2 windowSize, Camera* camera, ResourceManager* resources) {
 		this->windowSize = windowSize;
 		this->camera = camera;
-		this->lightPos = vec3(0.0, 400.0, 150.0);
-		mat4 lightProjection = ortho(-100.0f, 100.0f, -100.0f, 100.0f, 1.0f, 500.0f);
-		mat4 lightView = lookAt(lightPos, vec3(0.0f), vec3(0.0, 1.0, 0.0));
-		this->lightSpaceMatrix = lightProjection * lightView;
+		this->resources = resources;
+		// ɫύģͺڼ
+		LoadShader();
 		LoadModel();
 		LoadTexture();
-		LoadShader();
 	}
-	// ±任
+	// ±任͹ԴFrame
 	void Update() {
 		this->model = mat4(1.0);
-		this->view = camera->GetViewMatrix();
-		this->projection = perspective(radians(camera->GetZoom()), windowSize.x / windowSize.y, 0.1f, 500.0f);
 	}
-	// Ⱦ
-	void RoomRender(Shader* shader, int depthMap = -1) {
-		if (shader == NULL) {
-			shader = roomShader;
-			shader->Bind();
-			shader->SetMat4("view", view);
-			shader->SetMat4("projection", projection);
-		}
-		else {
-			shader->Bind();
-		}
-		shader->SetMat4("model", model);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, roomTexture->GetId());
-		if (depthMap != -1) {
-			glActiveTexture(GL_TEXTURE1);
-			glBindTexture(GL_TEXTURE_2D, depthMap);
-		}
-		glBindVertexArray(room->GetVAO());
-		glDrawElements(GL_TRIANGLES, static_cast<GLuint>(room->GetIndices().size()), GL_UNSIGNED_INT, 0);
-		shader->Unbind();
-		glBindVertexArray(0);
+	// ύӰȾסڱ
+	void SubmitRoom(RenderQueue* queue, const PipelineState* shadowPipeline, GLuint depthMap) {
+		DrawPacket packet(PASSSHADOW, LAYEROPAQUE, GROUPROOM, shadowPipeline);
+		packet.vertexArray = room->GetVAO();
+		packet.model = model * room->GetPositionTransform();
+		packet.draw = [this] { room->Draw(); };
+		queue->Submit(packet);
+
+		packet.pass = PASSMAIN;
+		packet.layer = LAYERBACKGROUND;
+		packet.pipeline = &roomPipeline;
+		packet.textures[0] = roomTexture->GetId();
+		packet.textures[SHADOWUNIT] = depthMap;
+		packet.normalMatrix = true;
+		queue->Submit(packet);
 	}
-	// Ⱦ̫
-	void SunRender() {
-		Shader* shader = sunShader;
-		shader->Bind();
-		shader->SetMat4("projection", projection);
-		shader->SetMat4("model", model);
-		shader->SetMat4("view", view);
-		glBindVertexArray(sun->GetVAO());
-		glDrawElements(GL_TRIANGLES, static_cast<GLuint>(sun->GetIndices().size()), GL_UNSIGNED_INT, 0);
-		shader->Unbind();
-		glBindVertexArray(0);
+	// ύ̫
+	void SubmitSun(RenderQueue* queue) {
+		// ̫ľǹԴλãͶӰ뾶ѡLOD
+		float focal = windowSize.y * 0.5f / tan(radians(camera->GetZoom()) * 0.5f);
+		float sunDistance = distance(LIGHTPOS, camera->GetPosition());
+		GLuint lod = sun->SelectLod(SUNRADIUS * focal / glm::max(sunDistance, 0.1f), LODPIXELS);
+		DrawPacket packet(PASSMAIN, LAYEROPAQUE, GROUPSUN, &sunPipeline);
+		packet.depth = sunDistance;
+		packet.vertexArray = sun->GetVAO();
+		packet.model = model * sun->GetPositionTransform();
+		packet.draw = [this, lod] { sun->Draw(lod); };
+		queue->Submit(packet);
 	}
 private:
 	// ģ
 	void LoadModel() {
-		room = new Model("res/model/room.obj");
-		sun = new Model("res/model/sun.obj");
+		// ߴϴλñfloat
+		room = resources->GetModel("res/model/room.obj", PACKDEFAULT);
+		sun = resources->GetModel("res/model/sun.obj", PACKCOMPACT, MAXLODS);
 	}
 	// 
 	void LoadTexture() {
-		roomTexture = new Texture("res/texture/wall.jpg");
+		roomTexture = resources->GetTexture("res/texture/wall.jpg");
 	}
 	// ɫ
 	void LoadShader() {
-		roomShader = new Shader("res/shader/room.vert", "res/shader/room.frag");
-		roomShader->Bind();
-		roomShader->SetInt("diffuse", 0);
-		roomShader->SetInt("shadowMap", 1);
-		roomShader->SetVec3("lightPos", lightPos);
-		roomShader->SetVec3("viewPos", camera->GetPosition());
-		roomShader->SetMat4("lightSpaceMatrix", lightSpaceMatrix);
-		roomShader->Unbind();
+		roomShader = resources->GetShader("res/shader/lit.vert", "res/shader/lit.frag", ROOMFEATURES, [](Shader* shader) {
+			shader->SetInt(UNIFORMDIFFUSE, 0);
+			shader->SetInt(UNIFORMSHADOWMAP, SHADOWUNIT);
+			shader->SetFloat(UNIFORMAMBIENTSTRENGTH, 0.5);
+		});
+		roomPipeline = PipelineState(roomShader.get());
 
-		sunShader = new Shader("res/shader/sun.vert", "res/shader/sun.frag");
-		sunShader->Bind();
-		sunShader->Unbind();
+		sunShader = resources->GetShader("res/shader/sun.vert", "res/shader/sun.frag");
+		sunPipeline = PipelineState(sunShader.get());
 	}
 };
 
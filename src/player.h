@@ -6,38 +6,45 @@
 #include "shader.h"
 #include "model.h"
 #include "camera.h"
+#include "resourcemanager.h"
+#include "renderqueue.h"
+
+const GLuint GUNFEATURES = SHADERNORMALMATRIX;		// ǹɫı
+const GLuint DOTFEATURES = SHADERUNLIT;			// ׼ɫı壬
 
 class Player {
 private:
 	vec2 windowSize;					// ڳߴ
 	// ǹ
-	Model* gun;
+	shared_ptr<Model> gun;
 	vec3 gunPos;						// ǹλ
-	Shader* gunShader;
+	shared_ptr<Shader> gunShader;
+	PipelineState gunPipeline;
 	mat4 gunModel;						// ǹģλñ任
-	Texture* diffuseMap;				// ͼ
-	Texture* specularMap;				// 淴ͼ
+	shared_ptr<Texture> diffuseMap;		// ͼ
+	shared_ptr<Texture> specularMap;	// 淴ͼ
 	float gunRecoil;					// 
 	// ׼
-	Model* dot;							
-	Shader* dotShader;
+	shared_ptr<Model> dot;
+	shared_ptr<Shader> dotShader;		// СͬһԴ޹ձ
+	PipelineState dotPipeline;
 	mat4 dotModel;						// ׼ģλñ任
 	// ͷ
 	Camera* camera;
-	// 任
-	mat4 projection;
-	mat4 view;
+	ResourceManager* resources;
 public:
-	Player(vec2 windowSize, Camera* camera) {
+	Player(vec2 windowSize, Camera* camera, ResourceManager* resources) {
 		this->windowSize = windowSize;
 		this->camera = camera;
+		this->resources = resources;
 		this->gunRecoil = 10.0f;
 		this->dotModel = mat4(1.0);
 		this->gunModel = mat4(1.0);
 
+		// ɫύģͺڼ
+		LoadShader();
 		LoadGun();
 		LoadTexture();
-		LoadShader();
 	}
 	// ±任ͷλõ
 	void Update(float deltaTime,  bool isShoot) {
@@ -46,8 +53,6 @@ public:
 		else
 			gunRecoil = 0.0f;
 
-		view = camera->GetViewMatrix();
-		projection = perspective(radians(camera->GetZoom()), windowSize.x / windowSize.y, 0.1f, 500.0f);
 		dotModel = mat4(1.0);
 		dotModel[3] = vec4(camera->GetPosition(), 1.0);
 		dotModel = translate(dotModel, camera->GetFront());
@@ -63,61 +68,54 @@ public:
 		gunModel = translate(gunModel, vec3(-0.225, 0.0, -0.225));
 		gunModel = rotate(gunModel, radians(-170.0f), vec3(0.0, 1.0, 0.0));
 	}
-	// Ⱦ
-	void Render() {
-		dotShader->Bind();
-		dotShader->SetMat4("projection", projection);
-		dotShader->SetMat4("view", view);
-		dotShader->SetMat4("model", dotModel);
-
-		glBindVertexArray(dot->GetVAO());
-		glDrawElements(GL_TRIANGLES, static_cast<GLuint>(dot->GetIndices().size()), GL_UNSIGNED_INT, 0);
-
-		gunShader->Bind();
-		gunShader->SetMat4("projection", projection);
-		gunShader->SetMat4("view", view);
-		gunShader->SetMat4("model", gunModel);
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, diffuseMap->GetId());
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, specularMap->GetId());
+	// ύǹ׼ǣǹռĻ󣬷ȻƵͼģͲ㣻׼ֻмأһ
+	void Submit(RenderQueue* queue) {
+		DrawPacket packet(PASSMAIN, LAYERVIEWMODEL, GROUPPLAYER, &gunPipeline);
+		packet.textures[0] = diffuseMap->GetId();
+		packet.textures[1] = specularMap->GetId();
+		packet.vertexArray = gun->GetVAO();
+		packet.model = gunModel * gun->GetPositionTransform();
+		packet.normalMatrix = true;
+		packet.draw = [this] { gun->Draw(); };
+		queue->Submit(packet);
 
-		glBindVertexArray(gun->GetVAO());
-		glDrawElements(GL_TRIANGLES, static_cast<GLuint>(gun->GetIndices().size()), GL_UNSIGNED_INT, 0);
-		
-		glBindVertexArray(0);
-		gunShader->Unbind();
+		// ׼ֱʹֵLOD
+		DrawPacket dotPacket(PASSMAIN, LAYEROPAQUE, GROUPPLAYER, &dotPipeline);
+		dotPacket.depth = 1.0f;
+		dotPacket.vertexArray = dot->GetVAO();
+		dotPacket.model = dotModel * dot->GetPositionTransform();
+		dotPacket.draw = [this] { dot->Draw(dot->GetLodCount() - 1); };
+		queue->Submit(dotPacket);
 	}
 private:
 	// ǹģ
 	void LoadGun() {
-		gun = new Model("res/model/gun.obj");
-		dot = new Model("res/model/dot.obj");
+		gun = resources->GetModel("res/model/gun.obj", PACKCOMPACT);
+		// СģͣСʵƣʹð뾫λ
+		dot = resources->GetSphere(PACKDEFAULT);
 	}
 	// 
 	void LoadTexture() {
-		diffuseMap = new Texture("res/texture/gun-diffuse-map.jpg");
-		specularMap = new Texture("res/texture/gun-specular-map.jpg");
+		diffuseMap = resources->GetTexture("res/texture/gun-diffuse-map.jpg");
+		specularMap = resources->GetTexture("res/texture/gun-specular-map.jpg");
 	}
 	// ɫ
 	void LoadShader() {
-		gunShader = new Shader("res/shader/gun.vert", "res/shader/gun.frag");
-		gunShader->Bind();
-		gunShader->SetInt("material.diffuse", 0);
-		gunShader->SetInt("material.specular", 1);
-		gunShader->SetFloat("material.shininess", 64.0);
-		gunShader->SetVec3("light.position", vec3(0.0, 400.0, 150.0));
-		gunShader->SetVec3("light.ambient", vec3(0.2));
-		gunShader->SetVec3("light.diffuse", vec3(0.65));
-		gunShader->SetVec3("light.specular", vec3(1.0));
-		gunShader->SetVec3("viewPos", camera->GetPosition());
-		gunShader->Unbind();
+		gunShader = resources->GetShader("res/shader/gun.vert", "res/shader/gun.frag", GUNFEATURES, [](Shader* shader) {
+			shader->SetInt(UNIFORMMATERIALDIFFUSE, 0);
+			shader->SetInt(UNIFORMMATERIALSPECULAR, 1);
+			shader->SetFloat(UNIFORMMATERIALSHININESS, 64.0);
+			shader->SetVec3(UNIFORMLIGHTAMBIENT, vec3(0.2));
+			shader->SetVec3(UNIFORMLIGHTDIFFUSE, vec3(0.65));
+			shader->SetVec3(UNIFORMLIGHTSPECULAR, vec3(1.0));
+		});
+		gunPipeline = PipelineState(gunShader.get());
 
-		dotShader = new Shader("res/shader/ball.vert", "res/shader/ball.frag");
-		dotShader->Bind();
-		dotShader->SetVec3("color", vec3(1.0, 0.0, 0.0));
-		dotShader->Unbind();
+		// ׼ǲҪպӰֻɫ
+		dotShader = resources->GetShader("res/shader/lit.vert", "res/shader/lit.frag", DOTFEATURES, [](Shader* shader) {
+			shader->SetVec3(UNIFORMCOLOR, vec3(1.0, 0.0, 0.0));
+		});
+		dotPipeline = PipelineState(dotShader.get());
 	}
 };
 
@@ -0,0 +1,118 @@
+#ifndef PROGRAMCACHE_H
+#define PROGRAMCACHE_H
+
+#include <glad/glad.h>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+using namespace std;
+#include "mappedfile.h"
+
+const char PROGRAMCACHEMAGIC[4] = { 'S', 'G', 'P', 'B' };
+const GLuint PROGRAMCACHEVERSION = 1;
+
+// ƻļͷglGetProgramBinaryȡõ
+struct ProgramCacheHeader {
+	char magic[4];
+	GLuint version;
+	uint64_t key;						// ɫԴϢĹϣκһı󻺴ʧЧ
+	GLenum binaryFormat;
+	GLuint length;
+};
+
+// ɫĶƻ棺һʱӲĳƣֱ֮glProgramBinary룬
+// ܾ£ʱɵ±롣ҪGL 4.1
+class ProgramCache {
+public:
+	// ļڶɫԱߣɫļͱĹܿ
+	static string GetCachePath(const string& vertexPath, const string& fragmentPath, GLuint features = 0) {
+		size_t slash = fragmentPath.find_last_of("/\\");
+		string path = vertexPath + "." + fragmentPath.substr(slash == string::npos ? 0 : slash + 1);
+		if (features != 0)
+			path += "." + to_string(features);
+		return path + ".program";
+	}
+	// Դ̡Ⱦ汾ַFNV-1aϣOpenGL̵߳
+	static uint64_t GetKey(const string& vertexCode, const string& fragmentCode) {
+		uint64_t hash = 14695981039346656037ULL;
+		hash = Hash(vertexCode, hash);
+		hash = Hash(fragmentCode, hash);
+		GLenum names[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+		for (GLuint i = 0; i < 3; i++) {
+			const char* value = (const char*)glGetString(names[i]);
+			hash = Hash(value != NULL ? value : "", hash);
+		}
+		return hash;
+	}
+	// Ƿֶ֧ȡ
+	static bool IsSupported() {
+		if (!GLAD_GL_VERSION_4_1)
+			return false;
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		return formats > 0;
+	}
+	// 뻺ĶƣɹʱprogramѾӺ
+	static bool Load(const string& path, uint64_t key, GLuint program) {
+		if (!IsSupported())
+			return false;
+		MappedFile file;
+		if (!file.Open(path) || file.GetSize() < sizeof(ProgramCacheHeader))
+			return false;
+		const ProgramCacheHeader* header = (const ProgramCacheHeader*)file.GetData();
+		if (memcmp(header->magic, PROGRAMCACHEMAGIC, 4) != 0 || header->version != PROGRAMCACHEVERSION || header->key != key)
+			return false;
+		if (file.GetSize() != sizeof(ProgramCacheHeader) + header->length)
+			return false;
+
+		glProgramBinary(program, header->binaryFormat, file.GetData() + sizeof(ProgramCacheHeader), header->length);
+		GLint success = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		return success != 0;
+	}
+	// ӳĶƣʧʱ棻ǰҪGL_PROGRAM_BINARY_RETRIEVABLE_HINT
+	static bool Save(const string& path, uint64_t key, GLuint program) {
+		GLint linked = 0;
+		if (IsSupported())
+			glGetProgramiv(program, GL_LINK_STATUS, &linked);
+		if (!linked)
+			return false;
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0)
+			return false;
+		vector<char> binary(length);
+		ProgramCacheHeader header;
+		memset(&header, 0, sizeof(header));
+		glGetProgramBinary(program, length, NULL, &header.binaryFormat, &binary[0]);
+		memcpy(header.magic, PROGRAMCACHEMAGIC, 4);
+		header.version = PROGRAMCACHEVERSION;
+		header.key = key;
+		header.length = length;
+
+		ofstream file(path, ios::binary | ios::trunc);
+		if (!file) {
+			cout << "Program cache failed to write at path: " << path << endl;
+			return false;
+		}
+		file.write((const char*)&header, sizeof(header));
+		file.write(&binary[0], length);
+		return file.good();
+	}
+private:
+	static uint64_t Hash(const string& text, uint64_t hash) {
+		for (size_t i = 0; i < text.size(); i++) {
+			hash ^= (unsigned char)text[i];
+			hash *= 1099511628211ULL;
+		}
+		// ָⲻͬƴӷʽõͬĹϣ
+		hash ^= 0xFF;
+		hash *= 1099511628211ULL;
+		return hash;
+	}
+};
+
+#endif // !PROGRAMCACHE_H
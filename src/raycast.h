@@ -0,0 +1,174 @@
+#ifndef RAYCAST_H
+#define RAYCAST_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+using namespace glm;
+#include <vector>
+#include <cmath>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+using namespace std;
+
+// ֻԵAVXMSVCҪ/arch:AVXʹAVXָGCCClangtargetԡ
+// Ŀ԰SSE룬ʱIsAvxSupportedǷ
+#ifdef __GNUC__
+#define AVX_TARGET __attribute__((target("avx")))
+#else
+#define AVX_TARGET
+#endif
+
+// һ󽻣İдx/y/zУ뾶ͬ
+// dirǵλpierceΪtrueʱ¼е򣨴͸ֻ¼һ
+// еŰСдhitsо룬ûʱ-1
+//
+// ocΪָĵb = dot(oc, dir)c = dot(oc, oc) - r * r
+// ֱཻΪ b * b - c >= 0ǰΪ b >= 0  c <= 0ڣ
+// ľΪ b - sqrt(b * b - c)ʱΪ0
+
+// һ򣬹汾SIMD汾ʣಿʹ
+inline void RaySphereOne(vec3 origin, vec3 dir, float x, float y, float z, float radius2, GLuint index,
+	bool pierce, vector<GLuint>& hits, float& nearest) {
+	float ox = x - origin.x, oy = y - origin.y, oz = z - origin.z;
+	float b = ox * dir.x + oy * dir.y + oz * dir.z;
+	float c = ox * ox + oy * oy + oz * oz - radius2;
+	float disc = b * b - c;
+	if (disc < 0 || (b < 0 && c > 0))
+		return;
+	float t = std::max(b - sqrt(disc), 0.0f);
+	if (pierce) {
+		hits.push_back(index);
+		if (nearest < 0 || t < nearest)
+			nearest = t;
+	}
+	else if (nearest < 0 || t < nearest) {
+		hits.clear();
+		hits.push_back(index);
+		nearest = t;
+	}
+}
+// 汾
+inline float RaySphereScalar(vec3 origin, vec3 dir, const float* x, const float* y, const float* z, GLuint count,
+	float radius, bool pierce, vector<GLuint>& hits) {
+	float nearest = -1;
+	hits.clear();
+	for (GLuint i = 0; i < count; i++)
+		RaySphereOne(origin, dir, x[i], y[i], z[i], radius * radius, i, pierce, hits, nearest);
+	return nearest;
+}
+// SSE汾ÿδ4
+inline float RaySphereSSE(vec3 origin, vec3 dir, const float* x, const float* y, const float* z, GLuint count,
+	float radius, bool pierce, vector<GLuint>& hits) {
+	float nearest = -1;
+	hits.clear();
+	const __m128 ox = _mm_set1_ps(origin.x), oy = _mm_set1_ps(origin.y), oz = _mm_set1_ps(origin.z);
+	const __m128 dx = _mm_set1_ps(dir.x), dy = _mm_set1_ps(dir.y), dz = _mm_set1_ps(dir.z);
+	const __m128 r2 = _mm_set1_ps(radius * radius);
+	const __m128 zero = _mm_setzero_ps();
+	GLuint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128 px = _mm_sub_ps(_mm_loadu_ps(x + i), ox);
+		__m128 py = _mm_sub_ps(_mm_loadu_ps(y + i), oy);
+		__m128 pz = _mm_sub_ps(_mm_loadu_ps(z + i), oz);
+		__m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, dx), _mm_mul_ps(py, dy)), _mm_mul_ps(pz, dz));
+		__m128 c = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py)), _mm_mul_ps(pz, pz)), r2);
+		__m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), c);
+		__m128 ahead = _mm_or_ps(_mm_cmpge_ps(b, zero), _mm_cmple_ps(c, zero));
+		int mask = _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(disc, zero), ahead));
+		if (mask == 0)
+			continue;
+
+		float t[4];
+		_mm_storeu_ps(t, _mm_max_ps(_mm_sub_ps(b, _mm_sqrt_ps(_mm_max_ps(disc, zero))), zero));
+		for (GLuint lane = 0; lane < 4; lane++) {
+			if (!(mask & (1 << lane)))
+				continue;
+			if (pierce) {
+				hits.push_back(i + lane);
+				if (nearest < 0 || t[lane] < nearest)
+					nearest = t[lane];
+			}
+			else if (nearest < 0 || t[lane] < nearest) {
+				hits.clear();
+				hits.push_back(i + lane);
+				nearest = t[lane];
+			}
+		}
+	}
+	for (; i < count; i++)
+		RaySphereOne(origin, dir, x[i], y[i], z[i], radius * radius, i, pierce, hits, nearest);
+	return nearest;
+}
+
+// CPUͲϵͳǷ֧AVXϵͳҪYMMĴ
+inline bool IsAvxSupported() {
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	return osxsave && avx && (_xgetbv(0) & 6) == 6;
+#elif defined(__GNUC__)
+	return __builtin_cpu_supports("avx");
+#else
+	return false;
+#endif
+}
+// AVX汾ÿδ8ֻIsAvxSupportedΪtrueʱ
+AVX_TARGET inline float RaySphereAVX(vec3 origin, vec3 dir, const float* x, const float* y, const float* z, GLuint count,
+	float radius, bool pierce, vector<GLuint>& hits) {
+	float nearest = -1;
+	hits.clear();
+	const __m256 ox = _mm256_set1_ps(origin.x), oy = _mm256_set1_ps(origin.y), oz = _mm256_set1_ps(origin.z);
+	const __m256 dx = _mm256_set1_ps(dir.x), dy = _mm256_set1_ps(dir.y), dz = _mm256_set1_ps(dir.z);
+	const __m256 r2 = _mm256_set1_ps(radius * radius);
+	const __m256 zero = _mm256_setzero_ps();
+	GLuint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 px = _mm256_sub_ps(_mm256_loadu_ps(x + i), ox);
+		__m256 py = _mm256_sub_ps(_mm256_loadu_ps(y + i), oy);
+		__m256 pz = _mm256_sub_ps(_mm256_loadu_ps(z + i), oz);
+		__m256 b = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, dx), _mm256_mul_ps(py, dy)), _mm256_mul_ps(pz, dz));
+		__m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, px), _mm256_mul_ps(py, py)), _mm256_mul_ps(pz, pz)), r2);
+		__m256 disc = _mm256_sub_ps(_mm256_mul_ps(b, b), c);
+		__m256 ahead = _mm256_or_ps(_mm256_cmp_ps(b, zero, _CMP_GE_OQ), _mm256_cmp_ps(c, zero, _CMP_LE_OQ));
+		int mask = _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(disc, zero, _CMP_GE_OQ), ahead));
+		if (mask == 0)
+			continue;
+
+		float t[8];
+		_mm256_storeu_ps(t, _mm256_max_ps(_mm256_sub_ps(b, _mm256_sqrt_ps(_mm256_max_ps(disc, zero))), zero));
+		for (GLuint lane = 0; lane < 8; lane++) {
+			if (!(mask & (1 << lane)))
+				continue;
+			if (pierce) {
+				hits.push_back(i + lane);
+				if (nearest < 0 || t[lane] < nearest)
+					nearest = t[lane];
+			}
+			else if (nearest < 0 || t[lane] < nearest) {
+				hits.clear();
+				hits.push_back(i + lane);
+				nearest = t[lane];
+			}
+		}
+	}
+	// 밴SSE룬YMMĴĸ߰벿֣AVXSSEлĴ
+	_mm256_zeroupper();
+	for (; i < count; i++)
+		RaySphereOne(origin, dir, x[i], y[i], z[i], radius * radius, i, pierce, hits, nearest);
+	return nearest;
+}
+
+// ʹеCPUֵָ֧һεʱ
+inline float RaySphere(vec3 origin, vec3 dir, const float* x, const float* y, const float* z, GLuint count,
+	float radius, bool pierce, vector<GLuint>& hits) {
+	static const bool avx = IsAvxSupported();
+	if (avx)
+		return RaySphereAVX(origin, dir, x, y, z, count, radius, pierce, hits);
+	return RaySphereSSE(origin, dir, x, y, z, count, radius, pierce, hits);
+}
+
+#endif // !RAYCAST_H
@@ -0,0 +1,150 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <functional>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+using namespace std;
+using namespace glm;
+#include "renderstate.h"
+#include "passtimer.h"
+
+// Ⱦ׶Σ˳ִ
+const GLuint PASSSHADOW = 0;				// ӹԴȾͼ
+const GLuint PASSMAIN = 1;					// Ⱦջ
+const GLuint PASSCOUNT = 2;
+
+// ͬһ׶еĻ˳
+const GLuint LAYERVIEWMODEL = 0;			// ǹ׼ǣռĻȻԾ޳
+const GLuint LAYEROPAQUE = 1;				// һĲ͸壬ӽԶ
+const GLuint LAYERBACKGROUND = 2;			// סķ䣬
+const GLuint LAYERTRANSLUCENT = 3;			// ͸壬Զ
+
+// ʱ飬ʱĽ׶ͬƼΪһ
+const GLuint GROUPPLAYER = 0;				// ǹ׼
+const GLuint GROUPROOM = 1;
+const GLuint GROUPSUN = 2;
+const GLuint GROUPBALLS = 3;
+const GLuint GROUPCOUNT = 4;
+const char* const GROUPNAMES[GROUPCOUNT] = { "player", "room", "sun", "balls" };
+
+const GLuint PACKETTEXTURES = SHADOWUNIT + 1;	// ÿλư󶨵ԪӰͼ
+const float SORTDEPTHRANGE = 500.0f;		// õȷΧͶӰԶƽһ
+
+// һλƣ״̬VAOģ;drawֻ𷢳
+struct DrawPacket {
+	GLuint pass;
+	GLuint layer;
+	GLuint group;						// ʱ
+	float depth;						// ľ
+	const PipelineState* pipeline;
+	GLuint textures[PACKETTEXTURES];	// 󶨵ӦԪ0ʾ
+	GLuint vertexArray;
+	mat4 model;
+	bool normalMatrix;					// ǷҪģ;߾
+	function<void()> draw;
+
+	DrawPacket(GLuint pass = PASSMAIN, GLuint layer = LAYEROPAQUE, GLuint group = GROUPPLAYER, const PipelineState* pipeline = NULL) {
+		this->pass = pass;
+		this->layer = layer;
+		this->group = group;
+		this->depth = 0.0f;
+		this->pipeline = pipeline;
+		for (GLuint i = 0; i < PACKETTEXTURES; i++)
+			this->textures[i] = 0;
+		this->vertexArray = 0;
+		this->model = mat4(1.0);
+		this->normalMatrix = false;
+	}
+};
+
+// ȾУÿ֡ύƣ64λļһѭִС
+// ӸߵΪ׶Ρ㡢ɫ򡢲ʣһVAOȣͬ״̬Ļһ
+// ͸ȷڳ֮ǰ֤Զ
+class RenderQueue {
+private:
+	struct Pass {
+		const char* name;
+		function<void()> setup;			// ׶ʱ֡塢ӿں
+		bool timeGroups;				// Ƿ񰴼ʱֱʱ
+	};
+	Pass passes[PASSCOUNT];
+	vector<DrawPacket> packets;
+	vector<pair<uint64_t, GLuint> > order;	// packetsе
+public:
+	RenderQueue() {
+		for (GLuint i = 0; i < PASSCOUNT; i++) {
+			passes[i].name = "";
+			passes[i].timeGroups = false;
+		}
+	}
+	// timeGroupsΪtrueʱ׶еĻưֱʱͬʱ׶εܺʱ
+	void SetPass(GLuint pass, const char* name, function<void()> setup, bool timeGroups = false) {
+		passes[pass].name = name;
+		passes[pass].setup = setup;
+		passes[pass].timeGroups = timeGroups;
+	}
+
+	void Submit(const DrawPacket& packet) {
+		order.push_back(make_pair(MakeKey(packet), (GLuint)packets.size()));
+		packets.push_back(packet);
+	}
+	// ִлƣȻնУûлƵĽ׶Ҳִsetup
+	void Execute(RenderState* state, PassTimer* timer) {
+		sort(order.begin(), order.end());
+		size_t next = 0;
+		for (GLuint pass = 0; pass < PASSCOUNT; pass++) {
+			bool timeGroups = timer != NULL && passes[pass].timeGroups;
+			if (timer != NULL)
+				timer->Begin(passes[pass].name);
+			if (passes[pass].setup)
+				passes[pass].setup();
+			if (timeGroups)
+				timer->End();
+			GLuint group = GROUPCOUNT;
+			for (; next < order.size() && packets[order[next].second].pass == pass; next++) {
+				const DrawPacket& packet = packets[order[next].second];
+				if (timeGroups && packet.group != group) {
+					if (group != GROUPCOUNT)
+						timer->End();
+					group = packet.group;
+					timer->Begin(GROUPNAMES[group], passes[pass].name);
+				}
+				Draw(state, packet);
+			}
+			if (timer != NULL && (!timeGroups || group != GROUPCOUNT))
+				timer->End();
+		}
+		packets.clear();
+		order.clear();
+	}
+private:
+	uint64_t MakeKey(const DrawPacket& packet) {
+		uint64_t program = packet.pipeline->shader->GetProgram() & 0xFFF;
+		uint64_t material = packet.textures[0] & 0xFFF;
+		uint64_t mesh = packet.vertexArray & 0xFFF;
+		uint64_t depth = (uint64_t)(glm::clamp(packet.depth / SORTDEPTHRANGE, 0.0f, 1.0f) * 0xFFFFFF);
+		uint64_t key = (uint64_t)(packet.pass & 0x3) << 62 | (uint64_t)(packet.layer & 0x3) << 60;
+		if (packet.layer == LAYERTRANSLUCENT)
+			return key | (0xFFFFFF - depth) << 36 | program << 24 | material << 12 | mesh;
+		return key | program << 48 | material << 36 | mesh << 24 | depth;
+	}
+
+	void Draw(RenderState* state, const DrawPacket& packet) {
+		state->Apply(*packet.pipeline);
+		for (GLuint unit = 0; unit < PACKETTEXTURES; unit++)
+			if (packet.textures[unit] != 0)
+				state->BindTexture(unit, packet.textures[unit]);
+		Shader* shader = packet.pipeline->shader;
+		shader->SetMat4(UNIFORMMODEL, packet.model);
+		if (packet.normalMatrix)
+			shader->SetMat3(UNIFORMNORMALMATRIX, transpose(inverse(mat3(packet.model))));
+		state->BindVertexArray(packet.vertexArray);
+		packet.draw();
+	}
+};
+
+#endif // !RENDERQUEUE_H
@@ -0,0 +1,164 @@
+#ifndef RENDERSTATE_H
+#define RENDERSTATE_H
+
+#include <glad/glad.h>
+#include "shader.h"
+
+const GLuint MAXTEXTUREUNITS = 16;			// ٰ󶨵Ԫ
+const GLuint UNKNOWNSTATE = 0xFFFFFFFF;		// ֪еĵǰֵһһ
+const GLuint SHADOWUNIT = 2;				// ӰͼרõԪʹ01ͼÿֻ֡һ
+
+// һֲʻʱĹ״̬ɫͻϡȡ޳ȹ̶״̬
+struct PipelineState {
+	Shader* shader;
+	bool blend;
+	bool depthTest;
+	bool depthWrite;
+	bool cull;
+
+	// ĬΪ͸壺ϣȲԲдȣ޳
+	PipelineState(Shader* shader = NULL) {
+		this->shader = shader;
+		this->blend = false;
+		this->depthTest = true;
+		this->depthWrite = true;
+		this->cull = false;
+	}
+};
+
+// ͱʡԵOpenGLô
+struct RenderStateStats {
+	size_t issued;
+	size_t elided;
+};
+
+// ¼OpenGLĵǰ״ֻ̬ı״̬ŵOpenGL
+// 루Դϴȣֱ޸İ󶨺ҪInvalidateBeginFrameʱԶ
+class RenderState {
+private:
+	GLuint program;
+	GLuint vertexArray;
+	GLuint framebuffer;
+	GLuint activeUnit;
+	GLuint textures[MAXTEXTUREUNITS];
+	GLint viewport[4];
+	GLuint blend;
+	GLuint depthTest;
+	GLuint depthWrite;
+	GLuint cull;
+
+	RenderStateStats frameStats;		// ǰ֡ļ
+	RenderStateStats totalStats;
+	GLuint frames;
+public:
+	RenderState() {
+		frames = 0;
+		memset(&frameStats, 0, sizeof(frameStats));
+		memset(&totalStats, 0, sizeof(totalStats));
+		Invalidate();
+	}
+	// м¼״̬
+	void Invalidate() {
+		program = UNKNOWNSTATE;
+		vertexArray = UNKNOWNSTATE;
+		framebuffer = UNKNOWNSTATE;
+		activeUnit = UNKNOWNSTATE;
+		for (GLuint i = 0; i < MAXTEXTUREUNITS; i++)
+			textures[i] = UNKNOWNSTATE;
+		viewport[0] = viewport[1] = viewport[2] = viewport[3] = -1;
+		blend = depthTest = depthWrite = cull = UNKNOWNSTATE;
+	}
+	// ÿ֡ʼȾʱã֮֡ϴܸı˰󶨣ȫ¼¼
+	void BeginFrame() {
+		memset(&frameStats, 0, sizeof(frameStats));
+		Invalidate();
+	}
+	// ÿ֡Ⱦʱãۼһ֡ļ
+	void EndFrame() {
+		totalStats.issued += frameStats.issued;
+		totalStats.elided += frameStats.elided;
+		frames++;
+	}
+	// лһֲʵĹ״̬
+	void Apply(const PipelineState& pipeline) {
+		UseProgram(pipeline.shader->GetProgram());
+		SetCapability(GL_BLEND, pipeline.blend, blend);
+		SetCapability(GL_DEPTH_TEST, pipeline.depthTest, depthTest);
+		SetCapability(GL_CULL_FACE, pipeline.cull, cull);
+		if (Changed(depthWrite, pipeline.depthWrite))
+			glDepthMask(pipeline.depthWrite ? GL_TRUE : GL_FALSE);
+	}
+
+	void UseProgram(GLuint program) {
+		if (Changed(this->program, program))
+			glUseProgram(program);
+	}
+
+	void BindVertexArray(GLuint vertexArray) {
+		if (Changed(this->vertexArray, vertexArray))
+			glBindVertexArray(vertexArray);
+	}
+	// Ѷά󶨵unitԪҪʱлǰԪ
+	void BindTexture(GLuint unit, GLuint texture) {
+		if (!Changed(textures[unit], texture))
+			return;
+		if (Changed(activeUnit, unit))
+			glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_2D, texture);
+	}
+
+	void BindFramebuffer(GLuint framebuffer) {
+		if (Changed(this->framebuffer, framebuffer))
+			glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	}
+
+	// ֡壬ʱҪд
+	void Clear(GLbitfield mask) {
+		if ((mask & GL_DEPTH_BUFFER_BIT) && Changed(depthWrite, true))
+			glDepthMask(GL_TRUE);
+		glClear(mask);
+	}
+
+	void Viewport(GLint x, GLint y, GLint width, GLint height) {
+		if (viewport[0] == x && viewport[1] == y && viewport[2] == width && viewport[3] == height) {
+			frameStats.elided++;
+			return;
+		}
+		viewport[0] = x;
+		viewport[1] = y;
+		viewport[2] = width;
+		viewport[3] = height;
+		frameStats.issued++;
+		glViewport(x, y, width, height);
+	}
+	// ֡ļ֮
+	RenderStateStats GetTotalStats() {
+		return totalStats;
+	}
+
+	GLuint GetFrameCount() {
+		return frames;
+	}
+private:
+	// ¼ֵԭͬʱΪʡԲfalse
+	bool Changed(GLuint& current, GLuint value) {
+		if (current == value) {
+			frameStats.elided++;
+			return false;
+		}
+		current = value;
+		frameStats.issued++;
+		return true;
+	}
+
+	void SetCapability(GLenum capability, bool enable, GLuint& current) {
+		if (!Changed(current, enable))
+			return;
+		if (enable)
+			glEnable(capability);
+		else
+			glDisable(capability);
+	}
+};
+
+#endif // !RENDERSTATE_H
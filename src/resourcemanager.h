@@ -0,0 +1,260 @@
+#ifndef RESOURCEMANAGER_H
+#define RESOURCEMANAGER_H
+
+#include <glad/glad.h>
+#include <string>
+#include <map>
+#include <memory>
+#include <iostream>
+#include <vector>
+#include <functional>
+using namespace std;
+#include "model.h"
+#include "texture.h"
+#include "shader.h"
+#include "icosphere.h"
+#include "assetloader.h"
+#include "texturestreamer.h"
+
+const size_t MEMORYBUDGET = 256 * 1024 * 1024;		// ĬԴԤ
+const chrono::milliseconds SHADERPOLLINTERVAL(1);	// ȴʱɫɵļ
+
+// ͳһģ͡ɫͬԴֻһΣüķʽһͷʱɾGPU
+class ResourceManager {
+private:
+	map<string, weak_ptr<Model> > models;
+	map<string, weak_ptr<Texture> > textures;
+	map<string, weak_ptr<Shader> > shaders;
+	size_t budget;						// ԴԤ㣨ֽڣ
+	bool overBudget;					// ǷѾʾԤ
+	AssetLoader* loader;				// Ϊʱģͺں̨
+	TextureStreamer* streamer;			// ̨ػϴ
+	bool compressTextures;				// ֧S3TCʱʹѹʽ
+	bool loading;						// Finish֮룬ɫƳٵ
+	// ύ롢ûuniformɫɺ󶨲öӦú
+	vector<pair<shared_ptr<Shader>, function<void(Shader*)> > > pendingShaders;
+public:
+	ResourceManager(size_t budget = MEMORYBUDGET) {
+		this->budget = budget;
+		this->overBudget = false;
+		this->loader = NULL;
+		this->streamer = NULL;
+		this->loading = false;
+		this->compressTextures = TextureCache::IsCompressionSupported();
+	}
+
+	// Ҫ֮ǰֹ֤ͣûй̻߳дػ
+	~ResourceManager() {
+		delete streamer;
+	}
+
+	// ų֮́ģͺȷؿյĶ󣬵Finishʹã
+	// FinishֻнСļÿ֡UpdateʽϴڴڼҪһֱ
+	void SetLoader(AssetLoader* loader) {
+		this->loader = loader;
+		this->loading = loader != NULL;
+		if (loader != NULL && streamer == NULL)
+			streamer = new TextureStreamer(loader);
+	}
+	// ȴ̨ȫɲϴʼʽϴOpenGL߳еá
+	// ȴڼ鲢бɫɵuniformʣµȴ
+	void Finish() {
+		if (loader != NULL)
+			while (loader->Poll(SHADERPOLLINTERVAL))
+				FinishShaders(false);
+		FinishShaders(true);
+		loading = false;
+		if (streamer != NULL)
+			streamer->Update();
+		CheckBudget();
+	}
+	// ÿ֡OpenGL߳еãִԴϴʽϴ
+	void Update() {
+		if (loader != NULL)
+			loader->ProcessUploads();
+		if (streamer != NULL)
+			streamer->Update();
+	}
+
+	// ͬĶʽLODkeepDataѡֿ
+	shared_ptr<Model> GetModel(const string& path, GLuint format = PACKNONE, GLuint lodCount = 1, bool keepData = false) {
+		string key = path;
+		if (format != PACKNONE || lodCount != 1)
+			key += "|" + to_string(format) + "|" + to_string(lodCount);
+		if (keepData)
+			key += "|data";
+		shared_ptr<Model> model = models[key].lock();
+		if (!model) {
+			if (loader != NULL) {
+				model = make_shared<Model>();
+				loader->Load([=] { model->Load(path, format, lodCount, keepData); }, [=] { model->Upload(); });
+			}
+			else
+				model = make_shared<Model>(path, format, lodCount, keepData);
+			models[key] = model;
+			CheckBudget();
+		}
+		return model;
+	}
+
+	// ɵ壬BALL_SPHERE_LEVELֵĹMAXLODSLODȡļ
+	shared_ptr<Model> GetSphere(GLuint format = PACKNONE) {
+		string key = "icosphere" + to_string(BALL_SPHERE_LEVEL) + "|" + to_string(format);
+		shared_ptr<Model> model = models[key].lock();
+		if (!model) {
+			vector<GLfloat> vertices;
+			vector<GLuint> indices;
+			vector<Submesh> submeshes;
+			Icosphere<BALL_SPHERE_LEVEL>::AppendLods(MAXLODS, vertices, indices, submeshes);
+			model = make_shared<Model>(vertices, indices, submeshes, MAXLODS, format);
+			models[key] = model;
+			CheckBudget();
+		}
+		return model;
+	}
+
+	shared_ptr<Texture> GetTexture(const string& path) {
+		shared_ptr<Texture> texture = textures[path].lock();
+		if (!texture) {
+			if (loader != NULL) {
+				texture = make_shared<Texture>();
+				bool compress = compressTextures;
+				TextureStreamer* streamer = this->streamer;
+				loader->Load([=] { texture->Load(path.c_str(), compress); }, [=] {
+					texture->Upload(true);
+					streamer->Add(texture);
+				});
+			}
+			else
+				texture = make_shared<Texture>(path.c_str(), compressTextures);
+			textures[path] = texture;
+			CheckBudget();
+		}
+		return texture;
+	}
+
+	// ͬһԴÿֹһı壬ϻ档setupɫʱһΣòuniform
+	// ڼ䣨SetLoader֮Finish֮ǰƳٵɣFinishеãʱ
+	shared_ptr<Shader> GetShader(const string& vertexPath, const string& fragmentPath, GLuint features = 0,
+		function<void(Shader*)> setup = nullptr) {
+		string key = vertexPath + "|" + fragmentPath;
+		if (features != 0)
+			key += "|" + to_string(features);
+		shared_ptr<Shader> shader = shaders[key].lock();
+		if (!shader) {
+			shader = make_shared<Shader>(vertexPath, fragmentPath, features);
+			shaders[key] = shader;
+			CheckBudget();
+		}
+		if (loading)
+			pendingShaders.push_back(make_pair(shader, setup));
+		else
+			SetupShader(shader.get(), setup);
+		return shader;
+	}
+
+	void SetBudget(size_t budget) {
+		this->budget = budget;
+		this->overBudget = false;
+		CheckBudget();
+	}
+
+	size_t GetCpuBytes() {
+		size_t total = 0;
+		for (auto it = models.begin(); it != models.end(); ++it)
+			if (shared_ptr<Model> model = it->second.lock())
+				total += model->GetCpuBytes();
+		return total;
+	}
+
+	size_t GetGpuBytes() {
+		size_t total = 0;
+		for (auto it = models.begin(); it != models.end(); ++it)
+			if (shared_ptr<Model> model = it->second.lock())
+				total += model->GetGpuBytes();
+		for (auto it = textures.begin(); it != textures.end(); ++it)
+			if (shared_ptr<Texture> texture = it->second.lock())
+				total += texture->GetGpuBytes();
+		for (auto it = shaders.begin(); it != shaders.end(); ++it)
+			if (shared_ptr<Shader> shader = it->second.lock())
+				total += shader->GetBinarySize();
+		return total;
+	}
+	// JSONʽÿԴռõڴԴ棨ֽڣ
+	void WriteJson(ostream& out) {
+		out << "{\n";
+		out << "        \"budget\": " << budget << ",\n";
+		out << "        \"cpu\": " << GetCpuBytes() << ",\n";
+		out << "        \"gpu\": " << GetGpuBytes() << ",\n";
+		// ʽϴûʱstreamedֻѾϴĲ
+		out << "        \"streamingDone\": " << (streamer == NULL || !streamer->IsBusy() ? "true" : "false") << ",\n";
+		out << "        \"streamedLevels\": " << (streamer != NULL ? streamer->GetStreamedLevels() : 0) << ",\n";
+		out << "        \"streamed\": " << (streamer != NULL ? streamer->GetStreamedBytes() : 0) << ",\n";
+		out << "        \"assets\": [";
+		bool first = true;
+		for (auto it = models.begin(); it != models.end(); ++it)
+			if (shared_ptr<Model> model = it->second.lock())
+				WriteAsset(out, first, "model", it->first, model->GetCpuBytes(), model->GetGpuBytes());
+		for (auto it = textures.begin(); it != textures.end(); ++it)
+			if (shared_ptr<Texture> texture = it->second.lock())
+				WriteAsset(out, first, "texture", it->first, 0, texture->GetGpuBytes());
+		for (auto it = shaders.begin(); it != shaders.end(); ++it)
+			if (shared_ptr<Shader> shader = it->second.lock())
+				WriteAsset(out, first, "shader", it->first, 0, shader->GetBinarySize());
+		out << "\n        ]\n    }";
+	}
+	// ڿ̨Դռ
+	void PrintReport() {
+		cout << "------------------------------ resources ------------------------------" << endl;
+		for (auto it = models.begin(); it != models.end(); ++it)
+			if (shared_ptr<Model> model = it->second.lock())
+				PrintAsset("model", it->first, model->GetCpuBytes(), model->GetGpuBytes());
+		for (auto it = textures.begin(); it != textures.end(); ++it)
+			if (shared_ptr<Texture> texture = it->second.lock())
+				PrintAsset("texture", it->first, 0, texture->GetGpuBytes());
+		for (auto it = shaders.begin(); it != shaders.end(); ++it)
+			if (shared_ptr<Shader> shader = it->second.lock())
+				PrintAsset("shader", it->first, 0, shader->GetBinarySize());
+		cout << "total: cpu " << GetCpuBytes() / 1024 << " KB, gpu " << GetGpuBytes() / 1024
+			<< " KB / budget " << budget / 1024 << " KB" << endl;
+	}
+private:
+	// ɱѾɫwaitΪtrueʱȴɫ
+	void FinishShaders(bool wait) {
+		size_t kept = 0;
+		for (size_t i = 0; i < pendingShaders.size(); i++) {
+			if (wait || pendingShaders[i].first->IsReady())
+				SetupShader(pendingShaders[i].first.get(), pendingShaders[i].second);
+			else
+				pendingShaders[kept++] = pendingShaders[i];
+		}
+		pendingShaders.resize(kept);
+	}
+
+	void SetupShader(Shader* shader, const function<void(Shader*)>& setup) {
+		shader->Bind();
+		if (setup)
+			setup(shader);
+		shader->Unbind();
+	}
+
+	void CheckBudget() {
+		if (overBudget || GetGpuBytes() <= budget)
+			return;
+		overBudget = true;
+		cout << "WARNING::RESOURCE::GPU memory " << GetGpuBytes() / 1024 << " KB exceeds budget " << budget / 1024 << " KB" << endl;
+	}
+
+	void WriteAsset(ostream& out, bool& first, const char* type, const string& key, size_t cpuBytes, size_t gpuBytes) {
+		out << (first ? "\n" : ",\n");
+		out << "            { \"type\": \"" << type << "\", \"key\": \"" << key
+			<< "\", \"cpu\": " << cpuBytes << ", \"gpu\": " << gpuBytes << " }";
+		first = false;
+	}
+
+	void PrintAsset(const char* type, const string& key, size_t cpuBytes, size_t gpuBytes) {
+		cout << type << "\t" << key << "\tcpu " << cpuBytes / 1024 << " KB\tgpu " << gpuBytes / 1024 << " KB" << endl;
+	}
+};
+
+#endif // !RESOURCEMANAGER_H
@@ -0,0 +1,106 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+using namespace std;
+
+// ׼Գ̶ڳߴ硢ϷģʽСĿӣ֤ÿпԸ
+struct Scenario {
+	string name;						// 
+	int width;							// ڿ
+	int height;							// ڸ߶
+	GLuint gameModel;					// Ϸģʽ
+	GLuint maxNumber;					// СĿ
+	float moveSpeed;					// Сƶٶ
+	unsigned int seed;					// 
+	GLuint frames;						// ֡
+	GLuint shootInterval;				// ÿ֡һǹ0ʾǹ
+	bool pierce;						// ӵǷ͸
+	GLuint weapon;						// 1ǹ2ǹ
+	int contextApi;						// Ĵʽ
+	GLuint memoryBudget;				// ԴԤ㣨MB
+	GLuint ballRenderer;				// СƷʽ12
+
+	Scenario() {
+		name = "default";
+		width = 1960;
+		height = 1080;
+		gameModel = 1;
+		maxNumber = 3;
+		moveSpeed = 0.1f;
+		seed = 0;
+		frames = 600;
+		shootInterval = 0;
+		pierce = true;
+		weapon = 1;
+		contextApi = GLFW_NATIVE_CONTEXT_API;
+		memoryBudget = 256;
+		ballRenderer = 1;
+	}
+	// ļжȡÿиʽΪ ֵ#ͷΪע
+	bool Load(const string& path) {
+		ifstream file(path);
+		if (!file) {
+			cout << "Scenario failed to load at path: " << path << endl;
+			return false;
+		}
+
+		string line;
+		while (getline(file, line)) {
+			stringstream stream(line);
+			string key;
+			if (!(stream >> key) || key[0] == '#')
+				continue;
+
+			if (key == "name")
+				stream >> name;
+			else if (key == "width")
+				stream >> width;
+			else if (key == "height")
+				stream >> height;
+			else if (key == "gameModel")
+				stream >> gameModel;
+			else if (key == "maxNumber")
+				stream >> maxNumber;
+			else if (key == "moveSpeed")
+				stream >> moveSpeed;
+			else if (key == "seed")
+				stream >> seed;
+			else if (key == "frames")
+				stream >> frames;
+			else if (key == "shootInterval")
+				stream >> shootInterval;
+			else if (key == "pierce")
+				stream >> pierce;
+			else if (key == "weapon")
+				stream >> weapon;
+			else if (key == "memoryBudget")
+				stream >> memoryBudget;
+			else if (key == "ballRenderer") {
+				string renderer;
+				stream >> renderer;
+				ballRenderer = renderer == "impostor" ? 2 : 1;
+			}
+			else if (key == "context") {
+				string api;
+				stream >> api;
+				if (api == "egl")
+					contextApi = GLFW_EGL_CONTEXT_API;
+				else if (api == "osmesa")
+					contextApi = GLFW_OSMESA_CONTEXT_API;
+				else
+					contextApi = GLFW_NATIVE_CONTEXT_API;
+			}
+			else
+				cout << "Scenario key '" << key << "' not defined" << endl;
+		}
+		return true;
+	}
+};
+
+#endif // !SCENARIO_H
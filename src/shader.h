@@ -8,71 +8,172 @@ using namespace glm;
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
 using namespace std;
+#include "frameuniforms.h"
+#include "programcache.h"
+
+// KHR_parallel_shader_compilegladУֶ
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+// ɫĹܿأʱ#define#version֮ͬһԴÿһĳ
+const GLuint SHADERSHADOWS = 1 << 0;		// Ӱͼ
+const GLuint SHADERSPECULAR = 1 << 1;		// 㾵淴
+const GLuint SHADERUNLIT = 1 << 2;			// գֱɫ
+const GLuint SHADERINSTANCED = 1 << 3;		// ʵλú
+const GLuint SHADERNORMALMATRIX = 1 << 4;	// ߾CPUϼ㣬Ϊuniform
+const GLuint SHADERTEXTURED = 1 << 5;		// ɫͼ
+const GLuint SHADERPHONG = 1 << 6;			// 淴PhongģͣߣĬΪBlinn-Phong
+const GLuint SHADERHALFWAYREFLECT = 1 << 7;	// 淴ð뷴ļнǣСԭеĸ߹
+const char* const SHADERFEATURENAMES[] = { "SHADOWS", "SPECULAR", "UNLIT", "INSTANCED", "NORMAL_MATRIX_UNIFORM", "TEXTURED", "PHONG", "HALFWAY_REFLECT" };
+const GLuint SHADERFEATURECOUNT = 8;
+const GLuint SHADERMAXINCLUDEDEPTH = 8;
+
+// uniformֵFNV-1aϣַڱ
+constexpr uint32_t HashName(const char* name) {
+	uint32_t hash = 2166136261u;
+	for (; *name != '\0'; name++) {
+		hash ^= (unsigned char)*name;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+// uniform֣ʱֻݹϣ캯explicitģֻconstexpr
+// ֤ϣڱÿʱַ
+struct UniformName {
+	uint32_t hash;
+	constexpr explicit UniformName(const char* name) : hash(HashName(name)) {}
+};
+
+// ɫõuniform
+constexpr UniformName UNIFORMMODEL("model");
+constexpr UniformName UNIFORMNORMALMATRIX("normalMatrix");
+constexpr UniformName UNIFORMCOLOR("color");
+constexpr UniformName UNIFORMDIFFUSE("diffuse");
+constexpr UniformName UNIFORMSHADOWMAP("shadowMap");
+constexpr UniformName UNIFORMAMBIENTSTRENGTH("ambientStrength");
+constexpr UniformName UNIFORMRADIUS("radius");
+constexpr UniformName UNIFORMMATERIALDIFFUSE("material.diffuse");
+constexpr UniformName UNIFORMMATERIALSPECULAR("material.specular");
+constexpr UniformName UNIFORMMATERIALSHININESS("material.shininess");
+constexpr UniformName UNIFORMLIGHTAMBIENT("light.ambient");
+constexpr UniformName UNIFORMLIGHTDIFFUSE("light.diffuse");
+constexpr UniformName UNIFORMLIGHTSPECULAR("light.specular");
+
+// Ӻѯһuniform¼һõֵֵʱϴ
+struct Uniform {
+	uint32_t hash;
+	GLint location;						// -1ʾλ
+	GLuint bytes;						// ֵֽ0ʾûù
+	float value[16];
+};
 
 class Shader {
 private:
 	GLuint program;				// ƣÿɫҲΨһĵԪ֮ƥ
+	vector<Uniform> uniforms;	// ϣѰַuniformСΪ2
+
+	// ύûмı룬һΰʱ
+	bool pending;
+	GLuint vertexShader;
+	GLuint fragmentShader;
+	uint64_t cacheKey;
+	string cachePath;
 public:
-	Shader(string vertexPath, string fragmentPath) {
-		string vertexCode;
-		string fragmentCode;
-		ifstream vShaderFile(vertexPath);
-		ifstream fShaderFile(fragmentPath);
-		stringstream vShaderStream, fShaderStream;
-
-		// ȡļеɫ
-		string line;
-		while (!vShaderFile.eof()) {
-			getline(vShaderFile, line);
-			vShaderStream << line + '\n';
-		}
-		while (!fShaderFile.eof()) {
-			getline(fShaderFile, line);
-			fShaderStream << line + '\n';
+	// ֧KHRARB_parallel_shader_compileʱ򿪺̨б룬glad֮һ
+	static void EnableParallelCompile(GLADloadproc load) {
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (GLint i = 0; i < count; i++) {
+			const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+			if (name == NULL)
+				continue;
+			const char* function = NULL;
+			if (strcmp(name, "GL_KHR_parallel_shader_compile") == 0)
+				function = "glMaxShaderCompilerThreadsKHR";
+			else if (strcmp(name, "GL_ARB_parallel_shader_compile") == 0)
+				function = "glMaxShaderCompilerThreadsARB";
+			if (function == NULL)
+				continue;
+			PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load(function);
+			if (maxThreads == NULL)
+				continue;
+			// 0xFFFFFFFFʾ߳
+			maxThreads(0xFFFFFFFF);
+			ParallelCompile() = true;
+			return;
 		}
+	}
 
-		// תΪstring
-		vertexCode = vShaderStream.str();
-		fragmentCode = fShaderStream.str();
+	// 뻺ĳƣ治ڻܾʱԴ룬»档
+	// ֻύȴһΰʱż󲢽uniformfeaturesΪSHADERͷĹܿ
+	Shader(string vertexPath, string fragmentPath, GLuint features = 0) {
+		string vertexCode = AddDefines(ReadSource(vertexPath), features);
+		string fragmentCode = AddDefines(ReadSource(fragmentPath), features);
 
-		const char* vShaderCode = vertexCode.c_str();
-		const char* fShaderCode = fragmentCode.c_str();
-
-		// ɫ
-		GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(vertexShader, 1, &vShaderCode, NULL);
-		glCompileShader(vertexShader);
-		checkCompileErrors(vertexShader, "VERTEX");
-		// Ƭɫ
-		GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(fragmentShader, 1, &fShaderCode, NULL);
-		glCompileShader(fragmentShader);
-		checkCompileErrors(fragmentShader, "FRAGMENT");
-		// ɫ
 		program = glCreateProgram();
-		glAttachShader(program, vertexShader);
-		glAttachShader(program, fragmentShader);
-		glLinkProgram(program);
-		checkCompileErrors(program, "PROGRAM");
-		// ɫӳɾ
-		glDeleteShader(vertexShader);
-		glDeleteShader(fragmentShader);
-	}
-
-	Shader(Shader* shader) {
-		program = shader->GetProgram();
+		pending = false;
+		vertexShader = fragmentShader = 0;
+		cacheKey = ProgramCache::GetKey(vertexCode, fragmentCode);
+		cachePath = ProgramCache::GetCachePath(vertexPath, fragmentPath, features);
+		if (ProgramCache::Load(cachePath, cacheKey, program))
+			Link();
+		else
+			Compile(vertexCode, fragmentCode);
 	}
 
 	~Shader() {
+		if (pending) {
+			glDeleteShader(vertexShader);
+			glDeleteShader(fragmentShader);
+		}
 		glDeleteProgram(program);
 	}
 
 	GLuint GetProgram() {
+		Finish();
 		return program;
 	}
-	// ɫ
+	// ƵĴС֧GL 4.1ڱʱ0
+	size_t GetBinarySize() {
+		GLint length = 0;
+		if (GLAD_GL_VERSION_4_1 && !pending)
+			glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		return length;
+	}
+	// ǷѾɣֲ֧бʱǷtrue
+	bool IsReady() {
+		if (!pending || !ParallelCompile())
+			return true;
+		GLint done = 0;
+		glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &done);
+		return done != 0;
+	}
+	// ȴɣ󡢱ơuniform
+	void Finish() {
+		if (!pending)
+			return;
+		pending = false;
+		checkCompileErrors(vertexShader, "VERTEX");
+		checkCompileErrors(fragmentShader, "FRAGMENT");
+		checkCompileErrors(program, "PROGRAM");
+		// ɫӳɾ
+		glDetachShader(program, vertexShader);
+		glDetachShader(program, fragmentShader);
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		ProgramCache::Save(cachePath, cacheKey, program);
+		Link();
+	}
+	// ɫһΰʱȴ
 	void Bind() {
+		Finish();
 		glUseProgram(program);
 	}
 	// ɫ
@@ -80,26 +181,124 @@ public:
 		glUseProgram(0);
 	}
 
-	void SetInt(const char* name, int val) {
-		glUniform1i(GetLocation(name), val);
+	// úҪȰ󶨱ɫɫвڣ򱻱ŻuniformֱӺ
+	void SetInt(UniformName name, int val) {
+		Uniform* uniform = Find(name.hash);
+		if (uniform != NULL && Changed(uniform, &val, sizeof(val)))
+			glUniform1i(uniform->location, val);
 	}
 
-	void SetFloat(const char* name, float val) {
-		glUniform1f(GetLocation(name), val);
+	void SetFloat(UniformName name, float val) {
+		Uniform* uniform = Find(name.hash);
+		if (uniform != NULL && Changed(uniform, &val, sizeof(val)))
+			glUniform1f(uniform->location, val);
 	}
 
-	void SetVec3(const char* name, vec3 val) {
-		glUniform3fv(GetLocation(name), 1, &val[0]);
+	void SetVec3(UniformName name, vec3 val) {
+		Uniform* uniform = Find(name.hash);
+		if (uniform != NULL && Changed(uniform, &val[0], sizeof(val)))
+			glUniform3fv(uniform->location, 1, &val[0]);
 	}
 
-	void SetMat3(const char* name, mat3 val) {
-		glUniformMatrix3fv(GetLocation(name), 1, GL_FALSE, &val[0][0]);
+	void SetMat3(UniformName name, mat3 val) {
+		Uniform* uniform = Find(name.hash);
+		if (uniform != NULL && Changed(uniform, &val[0][0], sizeof(val)))
+			glUniformMatrix3fv(uniform->location, 1, GL_FALSE, &val[0][0]);
 	}
 
-	void SetMat4(const char* name, mat4 val) {
-		glUniformMatrix4fv(GetLocation(name), 1, GL_FALSE, &val[0][0]);
+	void SetMat4(UniformName name, mat4 val) {
+		Uniform* uniform = Find(name.hash);
+		if (uniform != NULL && Changed(uniform, &val[0][0], sizeof(val)))
+			glUniformMatrix4fv(uniform->location, 1, GL_FALSE, &val[0][0]);
 	}
 private:
+	// һζļ
+	string ReadFile(const string& path) {
+		ifstream file(path, ios::binary);
+		if (!file)
+			cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << endl;
+		stringstream stream;
+		stream << file.rdbuf();
+		return stream.str();
+	}
+	// Դ벢չ#include "ļ"ļڵǰļڵĿ¼
+	string ReadSource(const string& path, GLuint depth = 0) {
+		string code = ReadFile(path);
+		if (depth >= SHADERMAXINCLUDEDEPTH) {
+			cout << "ERROR::SHADER::INCLUDE_TOO_DEEP: " << path << endl;
+			return code;
+		}
+		size_t slash = path.find_last_of("/\\");
+		string directory = slash == string::npos ? "" : path.substr(0, slash + 1);
+
+		string result;
+		istringstream lines(code);
+		string line;
+		while (getline(lines, line)) {
+			size_t start = line.find_first_not_of(" \t");
+			if (start != string::npos && line.compare(start, 8, "#include") == 0) {
+				size_t open = line.find('"', start);
+				size_t close = open == string::npos ? string::npos : line.find('"', open + 1);
+				if (close != string::npos) {
+					result += ReadSource(directory + line.substr(open + 1, close - open - 1), depth + 1);
+					result += '\n';
+					continue;
+				}
+				cout << "ERROR::SHADER::INVALID_INCLUDE: " << path << ": " << line << endl;
+			}
+			result += line;
+			result += '\n';
+		}
+		return result;
+	}
+	// #version֮#define#versionǵһָ
+	string AddDefines(const string& code, GLuint features) {
+		string defines;
+		for (GLuint i = 0; i < SHADERFEATURECOUNT; i++)
+			if (features & (1 << i))
+				defines += string("#define ") + SHADERFEATURENAMES[i] + "\n";
+		if (defines.empty())
+			return code;
+		size_t version = code.find("#version");
+		size_t end = version == string::npos ? string::npos : code.find('\n', version);
+		if (end == string::npos)
+			return defines + code;
+		return code.substr(0, end + 1) + defines + code.substr(end + 1);
+	}
+	// ύӣǰƣѯ״̬ȴ
+	void Compile(const string& vertexCode, const string& fragmentCode) {
+		const char* vShaderCode = vertexCode.c_str();
+		const char* fShaderCode = fragmentCode.c_str();
+
+		// ɫ
+		vertexShader = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(vertexShader, 1, &vShaderCode, NULL);
+		glCompileShader(vertexShader);
+		// Ƭɫ
+		fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(fragmentShader, 1, &fShaderCode, NULL);
+		glCompileShader(fragmentShader);
+		// ɫ
+		glAttachShader(program, vertexShader);
+		glAttachShader(program, fragmentShader);
+		if (GLAD_GL_VERSION_4_1)
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glLinkProgram(program);
+		pending = true;
+	}
+	// ɺuniformFrame
+	void Link() {
+		ReflectUniforms();
+		// 3.3ɫָ󶨵㣬ӺFrame󶨵FrameUniformsĻ
+		GLuint frameBlock = glGetUniformBlockIndex(program, "Frame");
+		if (frameBlock != GL_INVALID_INDEX)
+			glUniformBlockBinding(program, frameBlock, FRAMEBINDING);
+	}
+	// Ƿ˲б룬ɫ
+	static bool& ParallelCompile() {
+		static bool enabled = false;
+		return enabled;
+	}
 	// ɫûг
 	void checkCompileErrors(GLuint shader, string type) {
 		GLint success;
@@ -123,15 +322,58 @@ private:
 			}
 		}
 	}
-	// ȡɫڲĵַ
-	GLuint GetLocation(const char* name) {
-		GLint location = glGetUniformLocation(program, name);
+	// Ӻöлuniformϣuniformеıûеַ
+	void ReflectUniforms() {
+		GLint count = 0, maxLength = 0;
+		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+		GLuint capacity = 8;
+		while (capacity < (GLuint)count * 2)
+			capacity *= 2;
+		Uniform empty;
+		memset(&empty, 0, sizeof(empty));
+		empty.location = -1;
+		uniforms.assign(capacity, empty);
 
-		if (location == -1) {
-			cout << "Uniform '" << name << "' not defined" << endl;
+		vector<GLchar> name(maxLength + 1);
+		for (GLint i = 0; i < count; i++) {
+			GLint size;
+			GLenum type;
+			glGetActiveUniform(program, i, maxLength + 1, NULL, &size, &type, &name[0]);
+			GLint location = glGetUniformLocation(program, &name[0]);
+			if (location == -1)
+				continue;
+			// ִ"[0]"ȥֲ
+			char* bracket = strchr(&name[0], '[');
+			if (bracket != NULL)
+				*bracket = '\0';
+			uint32_t hash = HashName(&name[0]);
+			GLuint slot = hash & (capacity - 1);
+			while (uniforms[slot].location != -1) {
+				if (uniforms[slot].hash == hash)
+					cout << "ERROR::SHADER::uniform hash collision: " << &name[0] << endl;
+				slot = (slot + 1) & (capacity - 1);
+			}
+			uniforms[slot].hash = hash;
+			uniforms[slot].location = location;
 		}
-
-		return location;
+	}
+	// ϣuniformʱNULL
+	Uniform* Find(uint32_t hash) {
+		Finish();
+		GLuint mask = uniforms.size() - 1;
+		for (GLuint slot = hash & mask; uniforms[slot].location != -1; slot = (slot + 1) & mask)
+			if (uniforms[slot].hash == hash)
+				return &uniforms[slot];
+		return NULL;
+	}
+	// ϴõֵȽϣͬʱ¼ֵtrue
+	bool Changed(Uniform* uniform, const void* value, GLuint bytes) {
+		if (uniform->bytes == bytes && memcmp(uniform->value, value, bytes) == 0)
+			return false;
+		memcpy(uniform->value, value, bytes);
+		uniform->bytes = bytes;
+		return true;
 	}
 };
 
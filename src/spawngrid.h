@@ -0,0 +1,85 @@
+#ifndef SPAWNGRID_H
+#define SPAWNGRID_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+using namespace glm;
+#include <vector>
+#include <cmath>
+#include <algorithm>
+using namespace std;
+
+// Сͳ
+struct SpawnStats {
+	GLuint attempts;					// ȡܴ
+	GLuint spawned;						// ɹɵСĿ
+	GLuint failures;					// ɵĴ
+};
+
+// άжĳ㸽minDistanceûС
+// ӱ߳ΪminDistance/2ͬһֻһСÿжֻΧ5x5
+class SpawnGrid {
+private:
+	vec2 origin;						// ½
+	float minDistance;					// С֮С
+	float cellSize;						// ӱ߳
+	int columns;
+	int rows;
+	vector<vec2> points;				// ÿС
+	vector<bool> used;					// ǷС
+	int range;							// ҪĸӰ뾶
+public:
+	SpawnGrid(vec2 minCorner, vec2 maxCorner, float minDistance) {
+		this->origin = minCorner;
+		this->minDistance = minDistance;
+		this->cellSize = minDistance / sqrt(2.0f);
+		this->range = (int)ceil(minDistance / cellSize);
+		columns = (int)ceil((maxCorner.x - minCorner.x) / cellSize) + 1;
+		rows = (int)ceil((maxCorner.y - minCorner.y) / cellSize) + 1;
+		points.resize(columns * rows);
+		used.resize(columns * rows, false);
+	}
+	// ûСʱtrue
+	bool IsFree(vec2 pos) {
+		int cx = Column(pos.x);
+		int cy = Row(pos.y);
+		int minX = std::max(cx - range, 0), maxX = std::min(cx + range, columns - 1);
+		int minY = std::max(cy - range, 0), maxY = std::min(cy + range, rows - 1);
+		float limit = minDistance * minDistance;
+		for (int y = minY; y <= maxY; y++) {
+			for (int x = minX; x <= maxX; x++) {
+				int cell = y * columns + x;
+				if (!used[cell])
+					continue;
+				vec2 away = points[cell] - pos;
+				if (dot(away, away) < limit)
+					return false;
+			}
+		}
+		return true;
+	}
+	// ǰIsFree
+	void Insert(vec2 pos) {
+		int cell = Row(pos.y) * columns + Column(pos.x);
+		points[cell] = pos;
+		used[cell] = true;
+	}
+
+	void Remove(vec2 pos) {
+		used[Row(pos.y) * columns + Column(pos.x)] = false;
+	}
+
+	void Clear() {
+		used.assign(used.size(), false);
+	}
+private:
+	int Column(float x) {
+		return std::min(std::max((int)floor((x - origin.x) / cellSize), 0), columns - 1);
+	}
+
+	int Row(float y) {
+		return std::min(std::max((int)floor((y - origin.y) / cellSize), 0), rows - 1);
+	}
+};
+
+#endif // !SPAWNGRID_H
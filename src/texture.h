@@ -2,49 +2,139 @@
 #define TEXTURE_H
 
 #include <glad/glad.h>
-#include <stb_image/stb_image.h>
 #include <iostream>
+#include <vector>
 using namespace std;
+#include "texturecache.h"
+
+const size_t TEXTURESTREAMMINBYTES = 16 * 1024;	// Сļڷʱֱϴ֤һʼܲ
 
 class Texture {
 private:
 	GLuint id;
+	size_t gpuBytes;
+
+	// Load׼áȴUploadϴݣָ򻺴ӳɵĻ
+	MappedFile cacheFile;
+	vector<unsigned char> cooked;
+	const TextureCacheHeader* pending;
+	GLuint streamLevel;					// һҪʽϴļ1
+	GLuint baseLevel;					// һʼСһϴ
+	vector<bool> uploaded;
 public:
-	Texture(const char* path) {
+	// ֻʼ֮LoadȡUploadϴں̨
+	Texture() {
+		Init();
+	}
+	// compressΪtrueʱʹBC1/BC3/RGTC1ѹʽҪ֧S3TCTextureCache::IsCompressionSupported
+	Texture(const char* path, bool compress = false) {
+		Init();
+		Load(path, compress);
+		Upload();
+	}
+	// ӳ棬ЧʱͼƬɻ棬OpenGLڹִ߳
+	bool Load(const char* path, bool compress = false) {
+		uint64_t sourceHash = MeshCache::HashFile(path);
+		string cachePath = TextureCache::GetCachePath(path, compress);
+		pending = TextureCache::Open(cachePath, sourceHash, cacheFile);
+		if (pending != NULL)
+			return true;
+
+		if (!TextureCache::Cook(path, sourceHash, compress, cooked))
+			return false;
+		if (sourceHash != 0)
+			TextureCache::Save(cachePath, cooked);
+		pending = (const TextureCacheHeader*)&cooked[0];
+		return true;
+	}
+	// mipmapϴOpenGL̵߳ástreamΪtrueʱֻϴTEXTURESTREAMMINBYTESС
+	// TextureStreamerС𼶵UploadLevelȫϴͷ
+	void Upload(bool stream = false) {
+		if (pending == NULL)
+			return;
+		const TextureLevel* levels = TextureCache::GetLevels(pending);
+
 		glGenTextures(1, &id);
+		glBindTexture(GL_TEXTURE_2D, id);
+		// ͨĸȲһ4ı
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (GLuint level = 0; level < pending->levelCount; level++) {
+			if (TextureCache::IsCompressed(pending))
+				glCompressedTexImage2D(GL_TEXTURE_2D, level, pending->internalFormat, levels[level].width, levels[level].height, 0, levels[level].size, NULL);
+			else
+				glTexImage2D(GL_TEXTURE_2D, level, pending->internalFormat, levels[level].width, levels[level].height, 0, pending->format, GL_UNSIGNED_BYTE, NULL);
+			gpuBytes += levels[level].size;
+		}
+		uploaded.assign(pending->levelCount, false);
+		baseLevel = pending->levelCount;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, pending->levelCount - 1);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
-		int width, height, nrComponents;
-		unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
-		if (data) {
-			int format;
-			if (nrComponents == 1 || nrComponents == 2)
-				format = GL_RED;
-			else if (nrComponents == 3)
-				format = GL_RGB;
-			else if (nrComponents == 4)
-				format = GL_RGBA;
-
-			glBindTexture(GL_TEXTURE_2D, id);
-			glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-			glGenerateMipmap(GL_TEXTURE_2D);
-			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-
-			stbi_image_free(data);
+		streamLevel = pending->levelCount;
+		while (streamLevel > 0 && (!stream || levels[streamLevel - 1].size <= TEXTURESTREAMMINBYTES)) {
+			streamLevel--;
+			UploadLevel(streamLevel, GetLevelData(streamLevel));
 		}
-		else {
-			cout << "Texture failed to load at path: " << path << endl;
-			stbi_image_free(data);
+	}
+	// Ƿеȴʽϴļ
+	bool IsStreaming() {
+		return pending != NULL && streamLevel > 0;
+	}
+	// ȡһҪʽϴļ𣬴С
+	GLuint NextStreamLevel() {
+		return --streamLevel;
+	}
+
+	const void* GetLevelData(GLuint level) {
+		return TextureCache::GetLevelData(pending, level);
+	}
+
+	size_t GetLevelSize(GLuint level) {
+		return TextureCache::GetLevels(pending)[level].size;
+	}
+	// ϴһmipmapdataΪڴַGL_PIXEL_UNPACK_BUFFERʱΪеƫơ
+	// Χϴϸһʼδϴļ𲻻ᱻ
+	void UploadLevel(GLuint level, const void* data) {
+		const TextureLevel& info = TextureCache::GetLevels(pending)[level];
+		glBindTexture(GL_TEXTURE_2D, id);
+		if (TextureCache::IsCompressed(pending))
+			glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, info.width, info.height, pending->internalFormat, info.size, data);
+		else
+			glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, info.width, info.height, pending->format, GL_UNSIGNED_BYTE, data);
+
+		uploaded[level] = true;
+		while (baseLevel > 0 && uploaded[baseLevel - 1])
+			baseLevel--;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel);
+		if (baseLevel == 0) {
+			pending = NULL;
+			vector<unsigned char>().swap(cooked);
+			cacheFile.Close();
 		}
 	}
 
+	~Texture() {
+		glDeleteTextures(1, &id);
+	}
+
 	GLuint GetId() {
 		return id;
 	}
+
+	size_t GetGpuBytes() {
+		return gpuBytes;
+	}
+private:
+	void Init() {
+		id = 0;
+		gpuBytes = 0;
+		pending = NULL;
+		streamLevel = baseLevel = 0;
+	}
 };
 
 #endif
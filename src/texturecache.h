@@ -0,0 +1,319 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <glad/glad.h>
+#include <stb_image/stb_image.h>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+using namespace std;
+#include "mappedfile.h"
+#include "meshcache.h"
+
+// gladֻ˺ĹܣS3TCչﲹϸʽ
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+const char TEXTURECACHEMAGIC[4] = { 'S', 'G', 'T', 'C' };
+const GLuint TEXTURECACHEVERSION = 1;	// ʽʽıʱӣɻԶʧЧ
+const GLuint MAXTEXTURELEVELS = 16;
+
+// ļͷǸmipmapλñݣÿ뵽4ֽڣ
+struct TextureCacheHeader {
+	char magic[4];
+	GLuint version;
+	uint64_t sourceHash;				// ԴͼƬݵĹϣԴļı󻺴ʧЧ
+	GLuint width;
+	GLuint height;
+	GLuint levelCount;					// mipmapһֱС1x1
+	GLenum internalFormat;				// GL_RGBA8GL_R8ѹʽ
+	GLenum format;						// ѹʱglTexImage2DظʽѹʱΪ0
+	GLuint reserved;
+};
+
+// һmipmapļеλãoffsetļͷ
+struct TextureLevel {
+	GLuint width;
+	GLuint height;
+	GLuint offset;
+	GLuint size;
+};
+
+// Ԥ棺һʱstb_imageͼƬJPEGPNGȣCPUȫmipmapѹBC1/BC3/RGTC1
+// ֱ֮ӳ仺ļϴԴͼƬûиıʱٽ룬ҲglGenerateMipmap
+class TextureCache {
+public:
+	// ԴͼƬӦĻļ·ѹͲѹֿ
+	static string GetCachePath(const string& path, bool compress) {
+		return path + (compress ? ".bc.tex" : ".tex");
+	}
+	// Ƿ֧S3TCBC1/BC3OpenGL߳еãRGTC13.0ĺĹܣǿ
+	static bool IsCompressionSupported() {
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (GLint i = 0; i < count; i++) {
+			const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+			if (name != NULL && strcmp(name, "GL_EXT_texture_compression_s3tc") == 0)
+				return true;
+		}
+		return false;
+	}
+	// ӳ仺ļУ飬治ڡ汾ԴļѸıʱNULL
+	static const TextureCacheHeader* Open(const string& path, uint64_t sourceHash, MappedFile& file) {
+		if (sourceHash == 0 || !file.Open(path))
+			return NULL;
+		if (file.GetSize() < sizeof(TextureCacheHeader))
+			return NULL;
+		const TextureCacheHeader* header = (const TextureCacheHeader*)file.GetData();
+		if (!Validate(header, file.GetSize()) || header->sourceHash != sourceHash)
+			return NULL;
+		return header;
+	}
+
+	static const TextureLevel* GetLevels(const TextureCacheHeader* header) {
+		return (const TextureLevel*)((const unsigned char*)header + sizeof(TextureCacheHeader));
+	}
+
+	static const void* GetLevelData(const TextureCacheHeader* header, GLuint level) {
+		return (const unsigned char*)header + GetLevels(header)[level].offset;
+	}
+
+	static bool IsCompressed(const TextureCacheHeader* header) {
+		return header->format == 0;
+	}
+	// ͼƬɻݣcompressΪtrueʱRGBѹΪBC1RGBAѹΪBC3ͨѹΪRGTC1
+	static bool Cook(const string& path, uint64_t sourceHash, bool compress, vector<unsigned char>& out) {
+		int width, height, components;
+		unsigned char* data = stbi_load(path.c_str(), &width, &height, &components, 0);
+		if (data == NULL) {
+			cout << "Texture failed to load at path: " << path << endl;
+			return false;
+		}
+		// ͨͻҶȼ͸ֻһͨԭGL_REDϴһ£͸ȱչΪRGBA
+		GLuint channels = components <= 2 ? 1 : 4;
+		vector<unsigned char> pixels((size_t)width * height * channels);
+		for (size_t i = 0; i < (size_t)width * height; i++)
+			for (GLuint c = 0; c < channels; c++)
+				pixels[i * channels + c] = c < (GLuint)components ? data[i * components + c] : 255;
+		stbi_image_free(data);
+
+		TextureCacheHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, TEXTURECACHEMAGIC, 4);
+		header.version = TEXTURECACHEVERSION;
+		header.sourceHash = sourceHash;
+		header.width = width;
+		header.height = height;
+		header.levelCount = 1;
+		while (header.levelCount < MAXTEXTURELEVELS && (width >> header.levelCount > 0 || height >> header.levelCount > 0))
+			header.levelCount++;
+		if (channels == 1) {
+			header.internalFormat = compress ? GL_COMPRESSED_RED_RGTC1 : GL_R8;
+			header.format = compress ? 0 : GL_RED;
+		}
+		else if (components == 4) {
+			header.internalFormat = compress ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_RGBA8;
+			header.format = compress ? 0 : GL_RGBA;
+		}
+		else {
+			header.internalFormat = compress ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_RGBA8;
+			header.format = compress ? 0 : GL_RGBA;
+		}
+
+		out.assign(sizeof(header) + header.levelCount * sizeof(TextureLevel), 0);
+		vector<TextureLevel> levels(header.levelCount);
+		GLuint levelWidth = width, levelHeight = height;
+		for (GLuint level = 0; level < header.levelCount; level++) {
+			if (level > 0) {
+				Downsample(pixels, levelWidth, levelHeight, channels);
+				levelWidth = std::max<GLuint>(levelWidth / 2, 1);
+				levelHeight = std::max<GLuint>(levelHeight / 2, 1);
+			}
+			vector<unsigned char> encoded;
+			if (!compress)
+				encoded = pixels;
+			else
+				Encode(pixels, levelWidth, levelHeight, channels, header.internalFormat, encoded);
+			levels[level].width = levelWidth;
+			levels[level].height = levelHeight;
+			levels[level].offset = out.size();
+			levels[level].size = encoded.size();
+			out.insert(out.end(), encoded.begin(), encoded.end());
+			out.resize((out.size() + 3) & ~(size_t)3, 0);
+		}
+		memcpy(&out[0], &header, sizeof(header));
+		memcpy(&out[sizeof(header)], &levels[0], levels.size() * sizeof(TextureLevel));
+		return true;
+	}
+
+	static bool Save(const string& path, const vector<unsigned char>& data) {
+		ofstream file(path, ios::binary | ios::trunc);
+		if (!file) {
+			cout << "Texture cache failed to write at path: " << path << endl;
+			return false;
+		}
+		file.write((const char*)&data[0], data.size());
+		return file.good();
+	}
+private:
+	// ѹռõֽÿ4x4ĿBC1RGTC1Ϊ8ֽڣBC3Ϊ16ֽ
+	static size_t GetCompressedSize(GLuint width, GLuint height, GLenum internalFormat) {
+		size_t blocks = (size_t)((width + 3) / 4) * ((height + 3) / 4);
+		return blocks * (internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT ? 16 : 8);
+	}
+	// 4x4ɫѹBC1pixelsΪ16RGBAأ˵ȡΧУÿѡĵɫɫ
+	static void EncodeColorBlock(const unsigned char* pixels, unsigned char* out) {
+		unsigned char minColor[3] = { 255, 255, 255 }, maxColor[3] = { 0, 0, 0 };
+		for (GLuint i = 0; i < 16; i++)
+			for (GLuint c = 0; c < 3; c++) {
+				minColor[c] = std::min(minColor[c], pixels[i * 4 + c]);
+				maxColor[c] = std::max(maxColor[c], pixels[i * 4 + c]);
+			}
+		// Χ1/16С
+		for (GLuint c = 0; c < 3; c++) {
+			int inset = (maxColor[c] - minColor[c]) >> 4;
+			minColor[c] += inset;
+			maxColor[c] -= inset;
+		}
+		GLushort color0 = PackColor(maxColor), color1 = PackColor(minColor);
+		if (color0 < color1)
+			std::swap(color0, color1);
+
+		int palette[4][3];
+		UnpackColor(color0, palette[0]);
+		UnpackColor(color1, palette[1]);
+		for (GLuint c = 0; c < 3; c++) {
+			if (color0 > color1) {
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			else {
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+		GLuint bits = 0;
+		for (GLuint i = 0; i < 16; i++) {
+			GLuint best = 0;
+			int bestError = INT32_MAX;
+			for (GLuint k = 0; k < 4; k++) {
+				int error = 0;
+				for (GLuint c = 0; c < 3; c++) {
+					int d = palette[k][c] - pixels[i * 4 + c];
+					error += d * d;
+				}
+				if (error < bestError) {
+					bestError = error;
+					best = k;
+				}
+			}
+			bits |= best << (i * 2);
+		}
+		memcpy(out, &color0, 2);
+		memcpy(out + 2, &color1, 2);
+		memcpy(out + 4, &bits, 4);
+	}
+	// 4x4ĵͨѹRGTC1ҲBC3͸Ȳ֣valuesΪ16ֵstrideΪֵļ
+	static void EncodeChannelBlock(const unsigned char* values, GLuint stride, unsigned char* out) {
+		unsigned char minValue = 255, maxValue = 0;
+		for (GLuint i = 0; i < 16; i++) {
+			minValue = std::min(minValue, values[i * stride]);
+			maxValue = std::max(maxValue, values[i * stride]);
+		}
+		// value0 > value1ʱ˵ֵ֮6ֵ
+		int palette[8] = { maxValue, minValue };
+		for (GLuint k = 2; k < 8; k++)
+			palette[k] = maxValue > minValue ? ((8 - k) * maxValue + (k - 1) * minValue) / 7 : maxValue;
+		uint64_t bits = 0;
+		for (GLuint i = 0; i < 16; i++) {
+			uint64_t best = 0;
+			int bestError = INT32_MAX;
+			for (GLuint k = 0; k < 8; k++) {
+				int error = abs(palette[k] - values[i * stride]);
+				if (error < bestError) {
+					bestError = error;
+					best = k;
+				}
+			}
+			bits |= best << (i * 3);
+		}
+		out[0] = maxValue;
+		out[1] = minValue;
+		for (GLuint b = 0; b < 6; b++)
+			out[2 + b] = (unsigned char)(bits >> (b * 8));
+	}
+	static bool Validate(const TextureCacheHeader* header, size_t size) {
+		if (memcmp(header->magic, TEXTURECACHEMAGIC, 4) != 0 || header->version != TEXTURECACHEVERSION)
+			return false;
+		if (header->levelCount == 0 || header->levelCount > MAXTEXTURELEVELS)
+			return false;
+		if (size < sizeof(TextureCacheHeader) + header->levelCount * sizeof(TextureLevel))
+			return false;
+		const TextureLevel* levels = GetLevels(header);
+		for (GLuint i = 0; i < header->levelCount; i++)
+			if ((size_t)levels[i].offset + levels[i].size > size)
+				return false;
+		return true;
+	}
+	// Сһ룬2x2ȡƽߴʱԵظ
+	static void Downsample(vector<unsigned char>& pixels, GLuint width, GLuint height, GLuint channels) {
+		GLuint newWidth = std::max<GLuint>(width / 2, 1), newHeight = std::max<GLuint>(height / 2, 1);
+		vector<unsigned char> result((size_t)newWidth * newHeight * channels);
+		for (GLuint y = 0; y < newHeight; y++)
+			for (GLuint x = 0; x < newWidth; x++) {
+				GLuint x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+				GLuint y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+				for (GLuint c = 0; c < channels; c++) {
+					GLuint sum = pixels[((size_t)y0 * width + x0) * channels + c] + pixels[((size_t)y0 * width + x1) * channels + c]
+						+ pixels[((size_t)y1 * width + x0) * channels + c] + pixels[((size_t)y1 * width + x1) * channels + c];
+					result[((size_t)y * newWidth + x) * channels + c] = (sum + 2) / 4;
+				}
+			}
+		pixels.swap(result);
+	}
+	// ѹһmipmap4x4ĿظԵ
+	static void Encode(const vector<unsigned char>& pixels, GLuint width, GLuint height, GLuint channels, GLenum internalFormat, vector<unsigned char>& out) {
+		GLuint blockBytes = internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT ? 16 : 8;
+		out.resize(GetCompressedSize(width, height, internalFormat));
+		unsigned char block[16 * 4];
+		size_t offset = 0;
+		for (GLuint by = 0; by < height; by += 4)
+			for (GLuint bx = 0; bx < width; bx += 4) {
+				for (GLuint i = 0; i < 16; i++) {
+					GLuint x = std::min(bx + i % 4, width - 1), y = std::min(by + i / 4, height - 1);
+					memcpy(&block[i * channels], &pixels[((size_t)y * width + x) * channels], channels);
+				}
+				if (internalFormat == GL_COMPRESSED_RED_RGTC1)
+					EncodeChannelBlock(block, 1, &out[offset]);
+				else if (internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT) {
+					EncodeChannelBlock(block + 3, 4, &out[offset]);
+					EncodeColorBlock(block, &out[offset + 8]);
+				}
+				else
+					EncodeColorBlock(block, &out[offset]);
+				offset += blockBytes;
+			}
+	}
+
+	static GLushort PackColor(const unsigned char* color) {
+		return (GLushort)(((color[0] * 31 + 127) / 255) << 11 | ((color[1] * 63 + 127) / 255) << 5 | ((color[2] * 31 + 127) / 255));
+	}
+
+	static void UnpackColor(GLushort color, int* out) {
+		int r = color >> 11 & 31, g = color >> 5 & 63, b = color & 31;
+		out[0] = r << 3 | r >> 2;
+		out[1] = g << 2 | g >> 4;
+		out[2] = b << 3 | b >> 2;
+	}
+};
+
+#endif // !TEXTURECACHE_H
@@ -0,0 +1,157 @@
+#ifndef TEXTURESTREAMER_H
+#define TEXTURESTREAMER_H
+
+#include <glad/glad.h>
+#include <memory>
+#include <deque>
+#include <cstring>
+using namespace std;
+#include "texture.h"
+#include "assetloader.h"
+
+const GLuint STREAMSLOTS = 4;							// ػĸ
+const size_t STREAMSLOTSIZE = 4 * 1024 * 1024;			// ÿػĴСļֱӴڴϴ
+
+// ʽϴһѭʹõػPBO̰߳mipmapƽӳĻ
+// OpenGL߳ٴӻglTexSubImage2DÿСһʼÿ֡ڿеĻϴ𽥱
+class TextureStreamer {
+private:
+	struct Slot {
+		GLuint buffer;
+		unsigned char* mapped;		// ӳĵַǳ־ӳʱֻڸڼЧ
+		GLsync fence;				// һδϴɺٴд
+		bool busy;
+	};
+	Slot slots[STREAMSLOTS];
+	bool persistent;				// ֧4.4ʱʹó־ӳ䣬ÿʹʱӳ
+	deque<shared_ptr<Texture> > textures;		// мȴϴϴ
+	AssetLoader* loader;
+	size_t streamedBytes;			// ػϴֽ
+	GLuint streamedLevels;
+public:
+	TextureStreamer(AssetLoader* loader) {
+		this->loader = loader;
+		streamedBytes = 0;
+		streamedLevels = 0;
+		persistent = GLAD_GL_VERSION_4_4 != 0;
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		for (GLuint i = 0; i < STREAMSLOTS; i++) {
+			glGenBuffers(1, &slots[i].buffer);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slots[i].buffer);
+			if (persistent) {
+				glBufferStorage(GL_PIXEL_UNPACK_BUFFER, STREAMSLOTSIZE, NULL, flags);
+				slots[i].mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, STREAMSLOTSIZE, flags);
+			}
+			else {
+				glBufferData(GL_PIXEL_UNPACK_BUFFER, STREAMSLOTSIZE, NULL, GL_STREAM_DRAW);
+				slots[i].mapped = NULL;
+			}
+			slots[i].fence = 0;
+			slots[i].busy = false;
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+	// Ҫȵȴֹ֤ͣûй̻߳д
+	~TextureStreamer() {
+		for (GLuint i = 0; i < STREAMSLOTS; i++) {
+			if (slots[i].fence != 0)
+				glDeleteSync(slots[i].fence);
+			if (slots[i].mapped != NULL) {
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slots[i].buffer);
+				glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			}
+			glDeleteBuffers(1, &slots[i].buffer);
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+	// һѾø洢Texture::Upload
+	void Add(shared_ptr<Texture> texture) {
+		if (texture->IsStreaming())
+			textures.push_back(texture);
+	}
+	// ÿ֡OpenGL߳еãɵĻٸеĻһ
+	void Update() {
+		for (GLuint i = 0; i < STREAMSLOTS; i++) {
+			Slot& slot = slots[i];
+			if (slot.fence == 0)
+				continue;
+			GLenum status = glClientWaitSync(slot.fence, 0, 0);
+			if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+				continue;
+			glDeleteSync(slot.fence);
+			slot.fence = 0;
+			slot.busy = false;
+		}
+
+		GLuint index = 0;
+		while (index < STREAMSLOTS && !textures.empty()) {
+			if (slots[index].busy) {
+				index++;
+				continue;
+			}
+			shared_ptr<Texture> texture = textures.front();
+			textures.pop_front();
+			GLuint level = texture->NextStreamLevel();
+			if (texture->IsStreaming())
+				textures.push_back(texture);
+
+			if (texture->GetLevelSize(level) > STREAMSLOTSIZE) {
+				texture->UploadLevel(level, texture->GetLevelData(level));
+				continue;
+			}
+			Stream(index, texture, level);
+			index++;
+		}
+	}
+	// Ƿûɵϴ
+	bool IsBusy() {
+		if (!textures.empty())
+			return true;
+		for (GLuint i = 0; i < STREAMSLOTS; i++)
+			if (slots[i].busy)
+				return true;
+		return false;
+	}
+
+	size_t GetStreamedBytes() {
+		return streamedBytes;
+	}
+
+	GLuint GetStreamedLevels() {
+		return streamedLevels;
+	}
+private:
+	// ̰߳ѵlevelƵindexɺOpenGL̴߳ӻϴ
+	void Stream(GLuint index, shared_ptr<Texture> texture, GLuint level) {
+		Slot& slot = slots[index];
+		slot.busy = true;
+		if (!persistent) {
+			// ϴεϴѾɣԲȴֱͬӳ
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+			slot.mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, STREAMSLOTSIZE,
+				GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		unsigned char* destination = slot.mapped;
+		const void* source = texture->GetLevelData(level);
+		size_t size = texture->GetLevelSize(level);
+		loader->Load([destination, source, size] { memcpy(destination, source, size); },
+			[this, index, texture, level, size] { Finish(index, texture, level, size); });
+	}
+
+	void Finish(GLuint index, shared_ptr<Texture> texture, GLuint level, size_t size) {
+		Slot& slot = slots[index];
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+		if (!persistent) {
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			slot.mapped = NULL;
+		}
+		texture->UploadLevel(level, (void*)0);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		streamedBytes += size;
+		streamedLevels++;
+	}
+};
+
+#endif // !TEXTURESTREAMER_H
@@ -0,0 +1,166 @@
+#ifndef VERTEXFORMAT_H
+#define VERTEXFORMAT_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <vector>
+#include <cstring>
+using namespace std;
+using namespace glm;
+
+// ѹѡʹ
+const GLuint PACKNONE = 0;				// λáߡ궼floatÿ32ֽ
+const GLuint PACKNORMAL = 1;			// ѹΪ10_10_10_2
+const GLuint PACKHALFUV = 2;			// ʹð뾫ȸ
+const GLuint PACKUNORMUV = 4;			// ʹ16λ[0, 1]ʱ˻ذ뾫ȸ
+const GLuint PACKHALFPOSITION = 8;		// λðΧƽŵ[-1, 1]ʹð뾫ȸ任Ҫ˵ģ;
+const GLuint PACKDEFAULT = PACKNORMAL | PACKUNORMUV;			// ÿ20ֽ
+const GLuint PACKCOMPACT = PACKNORMAL | PACKUNORMUV | PACKHALFPOSITION;	// ÿ16ֽ
+
+// ʽѵʱÿ8floatѹָʽöӦĶ
+class VertexFormat {
+public:
+	// ÿֽ
+	static GLuint GetStride(GLuint format) {
+		return GetUVOffset(format) + (format & (PACKHALFUV | PACKUNORMUV) ? 4 : 8);
+	}
+	// ѡǷЩϣʵʹõĸʽ
+	static GLuint Resolve(GLuint format, const vector<GLfloat>& vertices) {
+		if (format & PACKUNORMUV) {
+			for (size_t i = 0; i < vertices.size(); i += 8)
+				if (vertices[i + 6] < 0.0f || vertices[i + 6] > 1.0f || vertices[i + 7] < 0.0f || vertices[i + 7] > 1.0f) {
+					format = (format & ~PACKUNORMUV) | PACKHALFUV;
+					break;
+				}
+		}
+		if (format & PACKUNORMUV)
+			format &= ~PACKHALFUV;
+		return format;
+	}
+	// λõİΧĺͳһţ֤ź[-1, 1]ڣͳһŲӰ취߱任
+	static void GetPositionBounds(const vector<GLfloat>& vertices, vec3& offset, float& scale) {
+		vec3 minCorner(0.0f), maxCorner(0.0f);
+		for (size_t i = 0; i < vertices.size(); i += 8) {
+			vec3 position(vertices[i], vertices[i + 1], vertices[i + 2]);
+			minCorner = i == 0 ? position : min(minCorner, position);
+			maxCorner = i == 0 ? position : max(maxCorner, position);
+		}
+		offset = (minCorner + maxCorner) * 0.5f;
+		vec3 extent = (maxCorner - minCorner) * 0.5f;
+		scale = glm::max(glm::max(extent.x, extent.y), extent.z);
+		if (scale <= 0.0f)
+			scale = 1.0f;
+	}
+	// ÿ8floatݰʽѹoffsetscaleֻڰ뾫λ
+	static void Pack(const vector<GLfloat>& vertices, GLuint format, vec3 offset, float scale, vector<unsigned char>& out) {
+		GLuint stride = GetStride(format);
+		size_t count = vertices.size() / 8;
+		out.assign(count * stride, 0);
+		for (size_t i = 0; i < count; i++) {
+			const GLfloat* src = &vertices[i * 8];
+			unsigned char* dst = &out[i * stride];
+
+			if (format & PACKHALFPOSITION) {
+				vec3 position = (vec3(src[0], src[1], src[2]) - offset) / scale;
+				uint16 half[4] = { packHalf1x16(position.x), packHalf1x16(position.y), packHalf1x16(position.z), 0 };
+				memcpy(dst, half, sizeof(half));
+			}
+			else
+				memcpy(dst, src, sizeof(GLfloat) * 3);
+
+			dst += GetNormalOffset(format);
+			if (format & PACKNORMAL) {
+				uint32 normal = packSnorm3x10_1x2(vec4(normalize(vec3(src[3], src[4], src[5])), 0.0f));
+				memcpy(dst, &normal, sizeof(normal));
+			}
+			else
+				memcpy(dst, src + 3, sizeof(GLfloat) * 3);
+
+			dst = &out[i * stride] + GetUVOffset(format);
+			if (format & PACKUNORMUV) {
+				uint16 uv[2] = { packUnorm1x16(src[6]), packUnorm1x16(src[7]) };
+				memcpy(dst, uv, sizeof(uv));
+			}
+			else if (format & PACKHALFUV) {
+				uint16 uv[2] = { packHalf1x16(src[6]), packHalf1x16(src[7]) };
+				memcpy(dst, uv, sizeof(uv));
+			}
+			else
+				memcpy(dst, src + 6, sizeof(GLfloat) * 2);
+		}
+	}
+	// ѹݻԭΪÿ8floatλûԭģͿռ
+	static void Unpack(const void* data, size_t count, GLuint format, vec3 offset, float scale, vector<GLfloat>& out) {
+		GLuint stride = GetStride(format);
+		out.resize(count * 8);
+		for (size_t i = 0; i < count; i++) {
+			const unsigned char* src = (const unsigned char*)data + i * stride;
+			GLfloat* dst = &out[i * 8];
+
+			if (format & PACKHALFPOSITION) {
+				uint16 half[3];
+				memcpy(half, src, sizeof(half));
+				vec3 position = vec3(unpackHalf1x16(half[0]), unpackHalf1x16(half[1]), unpackHalf1x16(half[2])) * scale + offset;
+				memcpy(dst, &position[0], sizeof(GLfloat) * 3);
+			}
+			else
+				memcpy(dst, src, sizeof(GLfloat) * 3);
+
+			src += GetNormalOffset(format);
+			if (format & PACKNORMAL) {
+				uint32 packed;
+				memcpy(&packed, src, sizeof(packed));
+				vec4 normal = unpackSnorm3x10_1x2(packed);
+				memcpy(dst + 3, &normal[0], sizeof(GLfloat) * 3);
+			}
+			else
+				memcpy(dst + 3, src, sizeof(GLfloat) * 3);
+
+			src = (const unsigned char*)data + i * stride + GetUVOffset(format);
+			if (format & (PACKHALFUV | PACKUNORMUV)) {
+				uint16 uv[2];
+				memcpy(uv, src, sizeof(uv));
+				dst[6] = format & PACKUNORMUV ? unpackUnorm1x16(uv[0]) : unpackHalf1x16(uv[0]);
+				dst[7] = format & PACKUNORMUV ? unpackUnorm1x16(uv[1]) : unpackHalf1x16(uv[1]);
+			}
+			else
+				memcpy(dst + 6, src, sizeof(GLfloat) * 2);
+		}
+	}
+	// õǰVAOĶԣλáߡ
+	static void SetAttributes(GLuint format) {
+		GLsizei stride = GetStride(format);
+
+		glEnableVertexAttribArray(0);
+		if (format & PACKHALFPOSITION)
+			glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, stride, (void*)0);
+		else
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+
+		glEnableVertexAttribArray(1);
+		if (format & PACKNORMAL)
+			glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)(size_t)GetNormalOffset(format));
+		else
+			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(size_t)GetNormalOffset(format));
+
+		glEnableVertexAttribArray(2);
+		if (format & PACKUNORMUV)
+			glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)(size_t)GetUVOffset(format));
+		else if (format & PACKHALFUV)
+			glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)(size_t)GetUVOffset(format));
+		else
+			glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(size_t)GetUVOffset(format));
+	}
+private:
+	// 뾫λò뵽44ֽڶ
+	static GLuint GetNormalOffset(GLuint format) {
+		return format & PACKHALFPOSITION ? 8 : 12;
+	}
+
+	static GLuint GetUVOffset(GLuint format) {
+		return GetNormalOffset(format) + (format & PACKNORMAL ? 4 : 12);
+	}
+};
+
+#endif // !VERTEXFORMAT_H
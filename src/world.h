@@ -6,6 +6,10 @@
 #include "player.h"
 #include "camera.h"
 #include "ballmanager.h"
+#include "passtimer.h"
+#include "resourcemanager.h"
+#include "frameuniforms.h"
+#include "renderqueue.h"
 
 class World {
 private:
@@ -16,28 +20,50 @@ private:
 	Player* player;				// 
 	Camera* camera;				// 
 	BallManager* ball;			// С
+	ResourceManager* resources;	// ģ͡ɫ
+	AssetLoader* loader;		// ̨ԴĹ߳
 
 	// Ӱ
 	GLuint depthMap;
 	GLuint depthMapFBO;
-	Shader* simpleDepthShader;
-	mat4 lightSpaceMatrix;
+	shared_ptr<Shader> simpleDepthShader;
+	PipelineState depthPipeline;
+	FrameUniforms* frame;		// ÿ֡õ͹Դ
+	RenderState* state;			// ֻı״̬OpenGL
+	RenderQueue* queue;			// ύĻƣͳһִ
+
+	PassTimer* timer;			// Ⱦ׶μʱΪʱʱ
+	GLuint targetFBO;			// ջ֡壬ĬΪ
 public:
 	World(GLFWwindow* window, vec2 windowSize) {
 		this->window = window;
 		this->windowSize = windowSize;
+		this->timer = NULL;
+		this->targetFBO = 0;
 
-		simpleDepthShader = new Shader("res/shader/shadow.vert", "res/shader/shadow.frag");
+		// ģͺڹ߳жȡͽ룬ɫͬʱУ
+		// ǰģȫϴϴСļ֮ļ֡ʽϴ
+		loader = new AssetLoader();
+		resources = new ResourceManager();
+		resources->SetLoader(loader);
+		// ڹʱԼɫֲ֧бʱں̨룬FinishȴʱǷ
+		simpleDepthShader = resources->GetShader("res/shader/shadow.vert", "res/shader/shadow.frag");
+		depthPipeline = PipelineState(simpleDepthShader.get());
 
-		vec3 lightPos(0.0, 400.0, 150.0);
+		// Դ̶Դռı任ֻһ
 		mat4 lightProjection = ortho(-100.0f, 100.0f, -100.0f, 100.0f, 1.0f, 500.0f);
-		mat4 lightView = lookAt(lightPos, vec3(0.0f), vec3(0.0, 1.0, 0.0));
-		lightSpaceMatrix = lightProjection * lightView;
+		mat4 lightView = lookAt(LIGHTPOS, vec3(0.0f), vec3(0.0, 1.0, 0.0));
+		frame = new FrameUniforms();
+		frame->SetLight(LIGHTPOS, lightProjection * lightView);
 
+		state = new RenderState();
+		queue = new RenderQueue();
+		queue->SetPass(PASSSHADOW, "shadow", [this] { BeginShadowPass(); });
+		queue->SetPass(PASSMAIN, "main", [this] { BeginMainPass(); }, true);
 		camera = new Camera(window);
-		place = new Place(windowSize, camera);
-		player = new Player(windowSize, camera);
-		ball = new BallManager(windowSize, camera);
+		place = new Place(windowSize, camera, resources);
+		player = new Player(windowSize, camera, resources);
+		ball = new BallManager(windowSize, camera, resources);
 
 		glGenFramebuffers(1, &depthMapFBO);
 		glGenTextures(1, &depthMap);
@@ -47,32 +73,78 @@ public:
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		// ͼĸ䣬ֻһ
+		glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMap, 0);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+		resources->Finish();
+		resources->PrintReport();
+	}
+	// ͷŸֳеԴãֹͣͷԴ
+	~World() {
+		delete ball;
+		delete player;
+		delete place;
+		delete camera;
+		simpleDepthShader.reset();
+		glDeleteTextures(1, &depthMap);
+		glDeleteFramebuffers(1, &depthMapFBO);
+		delete frame;
+		delete queue;
+		delete state;
+		delete loader;
+		delete resources;
 	}
 	// 
 	void Update(float deltaTime) {
+		// л
+		if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+			ball->SetWeapon(1);
+		if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+			ball->SetWeapon(2);
+		// лСĻƷʽ
+		if (glfwGetKey(window, GLFW_KEY_F1) == GLFW_PRESS)
+			ball->SetRenderMode(BALLMESH);
+		if (glfwGetKey(window, GLFW_KEY_F2) == GLFW_PRESS)
+			ball->SetRenderMode(BALLIMPOSTOR);
+		Update(deltaTime, glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS);
+	}
+	// ݣɵ߾Ƿǹ
+	void Update(float deltaTime, bool isShoot) {
 		camera->Update(deltaTime);
-		if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
-			ball->Update(camera->GetPosition(), camera->GetFront(), true);
-			player->Update(deltaTime, true);
-		}
-		else {
-			ball->Update(camera->GetPosition(), camera->GetFront(), false);
-			player->Update(deltaTime, false);
-		}
+		mat4 projection = perspective(radians(camera->GetZoom()), windowSize.x / windowSize.y, 0.1f, 500.0f);
+		frame->Update(camera->GetViewMatrix(), projection, camera->GetPosition());
+		ball->Update(camera->GetPosition(), camera->GetFront(), isShoot);
+		player->Update(deltaTime, isShoot);
 		place->Update();
 	}
 	// Ⱦģ
 	void Render() {
-		RenderDepth();
-		player->Render();
-		place->RoomRender(NULL, depthMap);
-		place->SunRender();
-		ball->Render(NULL, depthMap);
+		resources->Update();
+		state->BeginFrame();
+
+		// ˳Ⱦеֻռ
+		BeginPass("submit");
+		player->Submit(queue);
+		place->SubmitRoom(queue, &depthPipeline, depthMap);
+		place->SubmitSun(queue);
+		ball->Submit(queue, &depthPipeline, depthMap);
+		EndPass();
+
+		queue->Execute(state, timer);
+		state->EndFrame();
 	}
 
 	GLuint GetScore() {
 		return ball->GetScore();
 	}
+	// Сͳ
+	SpawnStats GetSpawnStats() {
+		return ball->GetSpawnStats();
+	}
 	// жϷǷ
 	bool IsOver() {
 		return ball->IsOver();
@@ -81,25 +153,75 @@ public:
 	void SetGameModel(GLuint num) {
 		ball->SetGameModel(num);
 	}
-private:
-	// Ⱦͼ
-	void RenderDepth() {
-		glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMap, 0);
-		glDrawBuffer(GL_NONE);
-		glReadBuffer(GL_NONE);
+	// СĿ
+	void SetMaxNumber(GLuint num) {
+		ball->SetMaxNumber(num);
+	}
+	// ӵǷ͸
+	void SetPierce(bool pierce) {
+		ball->SetPierce(pierce);
+	}
+	// 
+	void SetWeapon(GLuint weapon) {
+		ball->SetWeapon(weapon);
+	}
+	// Сƶٶ
+	void SetMoveSpeed(float speed) {
+		ball->SetMoveSpeed(speed);
+	}
+	// СĻƷʽ
+	void SetBallRenderMode(GLuint mode) {
+		ball->SetRenderMode(mode);
+	}
+
+	// ԴԤ㣨ֽڣ
+	void SetMemoryBudget(size_t budget) {
+		resources->SetBudget(budget);
+	}
+	// JSONʽԴռ
+	void WriteResourceJson(ostream& out) {
+		resources->WriteJson(out);
+	}
+	// ƽÿ֡ͱʡԵ״̬л
+	RenderStateStats GetStateStats() {
+		RenderStateStats stats = state->GetTotalStats();
+		GLuint frames = state->GetFrameCount();
+		if (frames > 0) {
+			stats.issued /= frames;
+			stats.elided /= frames;
+		}
+		return stats;
+	}
 
-		simpleDepthShader->Bind();
-		simpleDepthShader->SetMat4("lightSpaceMatrix", lightSpaceMatrix);
+	void SetTimer(PassTimer* timer) {
+		this->timer = timer;
+	}
+	// ջ֡壬Ⱦ
+	void SetTargetFramebuffer(GLuint fbo) {
+		targetFBO = fbo;
+	}
+private:
+	// Ӱ׶ΣȾͼ
+	void BeginShadowPass() {
+		state->BindFramebuffer(depthMapFBO);
+		state->Viewport(0, 0, 1024, 1024);
+		state->Clear(GL_DEPTH_BUFFER_BIT);
+	}
+	// Ⱦ׶ΣȾջ
+	void BeginMainPass() {
+		state->BindFramebuffer(targetFBO);
+		state->Viewport(0, 0, windowSize.x, windowSize.y);
+		state->Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	}
 
-		glViewport(0, 0, 1024, 1024);
-		glClear(GL_DEPTH_BUFFER_BIT);
-		place->RoomRender(simpleDepthShader);
-		ball->Render(simpleDepthShader);
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	void BeginPass(const char* name) {
+		if (timer != NULL)
+			timer->Begin(name);
+	}
 
-		glViewport(0, 0, windowSize.x, windowSize.y);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	void EndPass() {
+		if (timer != NULL)
+			timer->End();
 	}
 };
 